@@ -1,9 +1,10 @@
 #include <iostream>
-#include <deque>
+#include <cstdio>
 #include <ctime>
 
 #ifdef _WIN32
     #include <conio.h>  // For _kbhit() and _getch()
+    #define NOMINMAX          // windows.h's min/max macros break std::min/std::max
     #include <windows.h> // For Sleep()
 #else
     #include <unistd.h>  // For read() and usleep()
@@ -12,6 +13,8 @@
     #include <sys/ioctl.h>
 #endif
 
+#include "snake_unix/snake_core.h"
+
 using namespace std;
 
 // Cross-platform function to get terminal size
@@ -63,20 +66,8 @@ void moveCursorTo(int row, int col) {
 
 // Global Variables
 int rows = 0, cols = 0;
-int fx = 0, fy = 0;
 int borderWidth = 60;
 int borderHeight = 20;
-char dir = 'd';
-bool run = true;
-deque<pair<int, int>> snake;
-
-// Food placement
-void CreateFood(int top, int left) {
-    fx = left + 1 + rand() % (borderWidth - 2);
-    fy = top + 1 + rand() % (borderHeight - 2);
-    moveCursorTo(fy, fx);
-    printf("\033[31m@\033[0m");
-}
 
 // Draw game borders
 void DrawBorders(int top, int left) {
@@ -95,45 +86,6 @@ void DrawBorders(int top, int left) {
     cout.flush();
 }
 
-// Draw snake
-void DrawSnake() {
-    for (const auto &part : snake) {
-        moveCursorTo(part.first, part.second);
-        printf("\033[32mS\033[0m");
-    }
-    cout.flush();
-}
-
-// Update snake position
-void UpdateSnake(int top, int left) {
-    static int dx[] = {-1, 1, 0, 0};
-    static int dy[] = {0, 0, -1, 1};
-    static char dirs[] = {'w', 's', 'a', 'd'};
-
-    int dirIndex = 0;
-    for (; dirIndex < 4; ++dirIndex)
-        if (dir == dirs[dirIndex]) break;
-
-    int currRow = snake.front().first + dx[dirIndex];
-    int currCol = snake.front().second + dy[dirIndex];
-
-    if (currRow < top || currRow >= top + borderHeight ||
-        currCol <= left || currCol >= left + borderWidth) {
-        run = false;
-        return;
-    }
-
-    snake.push_front({currRow, currCol});
-    if (currRow == fy && currCol == fx) {
-        CreateFood(top, left);
-    } else {
-        moveCursorTo(snake.back().first, snake.back().second);
-        cout << " ";
-        snake.pop_back();
-    }
-    DrawSnake();
-}
-
 // Read keyboard input (cross-platform)
 char getInput() {
     #ifdef _WIN32
@@ -149,51 +101,75 @@ char getInput() {
     return '\0';
 }
 
-int main() {
-    printf("\033[H\033[J");
-
-    #ifndef _WIN32
-        enableRawMode();
-        setNonBlockingInput();
-    #endif
-
-    getTerminalSize(rows, cols);
-
-    int top = (rows - borderHeight) / 2;
-    int left = (cols - borderWidth) / 2;
-    int midRow = rows / 2;
-    int midCol = cols / 2;
+// Policies for the shared game loop in snake_unix/snake_core.h. The
+// platform differences stay in here, decided at compile time.
 
-    DrawBorders(top, left);
+// ANSI output, which both platforms' terminals understand
+struct AnsiTerminal {
+    int top = 0, left = 0;
 
-    snake.push_back({midRow, midCol});
-    moveCursorTo(midRow, midCol);
-    cout << "S" << endl;
+    void clear(const GameState &) {
+        printf("\033[H\033[J");
+        getTerminalSize(rows, cols);
+        top = (rows - borderHeight) / 2;
+        left = (cols - borderWidth) / 2;
+        DrawBorders(top, left);
+    }
 
-    srand(static_cast<unsigned int>(time(0)));
-    CreateFood(top, left);
+    // Colour the terminal is drawing with. A redraw sends it once for the
+    // whole snake instead of around every segment; blanks show no colour.
+    Cell pen = Cell::EMPTY;
 
-    // Main Game Loop
-    while (run) {
-        char ch = getInput();
-        if (ch) { // If key is pressed
-            switch (ch) {
-                case 'd': if (dir != 'a') dir = 'd'; break;
-                case 'a': if (dir != 'd') dir = 'a'; break;
-                case 'w': if (dir != 's') dir = 'w'; break;
-                case 's': if (dir != 'w') dir = 's'; break;
-                case 'q': run = false; break;
-            }
+    // Board cells sit inside the border: row 0 is at `top`, column 0 just right of `left`.
+    void cell(pair<int, int> pos, Cell what) {
+        moveCursorTo(top + pos.first, left + 1 + pos.second);
+        if (what != Cell::EMPTY && what != pen) {
+            printf(what == Cell::SNAKE ? "\033[32m" : "\033[31m");
+            pen = what;
         }
+        putchar(what == Cell::SNAKE ? 'S' : what == Cell::FOOD ? '@' : ' ');
+    }
 
-        UpdateSnake(top, left);
+    void present(const GameState &) {
+        if (pen != Cell::EMPTY)
+            printf("\033[0m");
+        pen = Cell::EMPTY;
+        fflush(stdout);
+    }
+};
 
+struct SleepClock {
+    void start() {}
+    void wait() {
         #ifdef _WIN32
             Sleep(150);  // Windows
         #else
             usleep(150000); // Linux/macOS
         #endif
     }
+};
+
+struct KeyboardInput {
+    template <typename F>
+    void poll(F &&onKey) {
+        for (char ch = getInput(); ch; ch = getInput()) {
+            if (!onKey(ch))
+                return;
+        }
+    }
+};
+
+int main() {
+    #ifndef _WIN32
+        enableRawMode();
+        setNonBlockingInput();
+    #endif
+
+    GameCore<AnsiTerminal, SleepClock, KeyboardInput> core;
+    core.reset(borderWidth - 1, borderHeight, 1, static_cast<uint64_t>(time(0)));
+
+    // Main Game Loop
+    core.run();
 
     return 0;
 }
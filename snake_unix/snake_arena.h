@@ -0,0 +1,288 @@
+#pragma once
+
+// Shared board for the multiplayer server.
+//
+// Every connected player owns one snake. All snakes move at once in
+// step(), with the single-player rules applied to each: running into a
+// wall or any snake cell (tails included) is fatal, and two heads that
+// reach the same cell in the same tick both die. A dead snake disappears
+// and the player comes back RESPAWN_TICKS later at a random empty cell.
+//
+// Every cell write goes through set(), which also appends the write to
+// `changes`, so after step() that list is exactly the delta to broadcast.
+
+#include <cstdint>
+#include <vector>
+
+#include "snake_engine.h"
+#include "snake_input.h"
+#include "snake_net.h"
+
+constexpr uint64_t RESPAWN_TICKS = 20;
+constexpr int SPAWN_ATTEMPTS = 64;
+constexpr uint64_t ARENA_BYTES_PER_CELL = 2 * sizeof(uint16_t) + sizeof(uint64_t); // cells, claimedBy, claimTick
+
+struct ArenaPlayer
+{
+    bool connected = false;
+    bool alive = false;
+    Direction dir = Direction::RIGHT;
+    TurnQueue turns;
+    SnakeRing body;
+    unsigned int score = 0;
+    uint64_t respawnTick = 0;
+    uint32_t target = 0; // cell the head moves to this tick
+    bool dying = false;
+};
+
+struct Arena
+{
+    int width = 0, height = 0;
+    int foodCount = 1;
+    int foodOnBoard = 0;
+    uint64_t tick = 0;
+    Rng rng;
+
+    std::vector<uint16_t> cells;       // CELL_EMPTY, CELL_FOOD or CELL_SNAKE + id
+    std::vector<ArenaPlayer> players;  // indexed by player id
+    std::vector<uint16_t> freeIds;
+    std::vector<CellChange> changes;   // cell writes since the last step()
+
+    // Head-on collisions: which tick and player last claimed each cell
+    std::vector<uint64_t> claimTick;
+    std::vector<uint16_t> claimedBy;
+
+    void reset(int boardWidth, int boardHeight, int food, uint64_t seed)
+    {
+        width = boardWidth;
+        height = boardHeight;
+        foodCount = food;
+        foodOnBoard = 0;
+        tick = 0;
+        rng.seed(seed);
+        size_t area = static_cast<size_t>(width) * static_cast<size_t>(height);
+        cells.assign(area, CELL_EMPTY);
+        claimTick.assign(area, UINT64_MAX);
+        claimedBy.assign(area, 0);
+        players.clear();
+        freeIds.clear();
+        changes.clear();
+        spawnFood();
+    }
+
+    void set(uint32_t cell, uint16_t value)
+    {
+        cells[cell] = value;
+        changes.push_back({cell, value});
+    }
+
+    // Random empty cell, by rejection first and then a scan from a random
+    // start so a crowded board still finds one. False if the board is full.
+    bool randomEmptyCell(uint32_t &cell)
+    {
+        uint32_t area = static_cast<uint32_t>(cells.size());
+        for (int attempt = 0; attempt < SPAWN_ATTEMPTS; ++attempt)
+        {
+            cell = rng.below(area);
+            if (cells[cell] == CELL_EMPTY)
+                return true;
+        }
+        uint32_t start = rng.below(area);
+        for (uint32_t i = 0; i < area; ++i)
+        {
+            cell = (start + i) % area;
+            if (cells[cell] == CELL_EMPTY)
+                return true;
+        }
+        return false;
+    }
+
+    void spawnFood()
+    {
+        uint32_t cell;
+        while (foodOnBoard < foodCount && randomEmptyCell(cell))
+        {
+            set(cell, CELL_FOOD);
+            foodOnBoard++;
+        }
+    }
+
+    bool spawn(uint16_t id)
+    {
+        ArenaPlayer &player = players[id];
+        uint32_t cell;
+        if (!randomEmptyCell(cell))
+            return false;
+        player.alive = true;
+        player.dying = false;
+        player.score = 0;
+        player.dir = static_cast<Direction>(rng.below(4));
+        player.turns.clear();
+        player.body.clear();
+        player.body.push_front(cell);
+        set(cell, static_cast<uint16_t>(CELL_SNAKE + id));
+        return true;
+    }
+
+    void kill(uint16_t id)
+    {
+        ArenaPlayer &player = players[id];
+        while (player.body.size())
+            set(player.body.pop_back(), CELL_EMPTY);
+        player.alive = false;
+        player.respawnTick = tick + RESPAWN_TICKS;
+    }
+
+    // Adds a player and spawns their snake. Returns the new player id.
+    uint16_t join()
+    {
+        uint16_t id;
+        if (!freeIds.empty())
+        {
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        else
+        {
+            id = static_cast<uint16_t>(players.size());
+            players.emplace_back();
+        }
+        players[id].connected = true;
+        if (!spawn(id))
+            players[id].respawnTick = tick + RESPAWN_TICKS;
+        return id;
+    }
+
+    void leave(uint16_t id)
+    {
+        if (players[id].alive)
+            kill(id);
+        players[id].connected = false;
+        freeIds.push_back(id);
+    }
+
+    // Same meaning as the keys in handleInput(): w/a/s/d queue a turn.
+    void input(uint16_t id, char key)
+    {
+        ArenaPlayer &player = players[id];
+        Direction to;
+        switch (key)
+        {
+        case 'w':
+            to = Direction::UP;
+            break;
+        case 's':
+            to = Direction::DOWN;
+            break;
+        case 'a':
+            to = Direction::LEFT;
+            break;
+        case 'd':
+            to = Direction::RIGHT;
+            break;
+        default:
+            return;
+        }
+        player.turns.push(player.dir, to);
+    }
+
+    // Advances every snake by one tick. `changes` afterwards holds this
+    // tick's delta (plus any joins and leaves since the last call).
+    void step()
+    {
+        tick++;
+        uint16_t count = static_cast<uint16_t>(players.size());
+
+        // Pick every head's target against the board as it was last tick
+        for (uint16_t id = 0; id < count; ++id)
+        {
+            ArenaPlayer &player = players[id];
+            if (!player.alive)
+                continue;
+            player.turns.pop(player.dir);
+
+            uint32_t head = player.body.front();
+            int row = static_cast<int>(head / static_cast<uint32_t>(width));
+            int col = static_cast<int>(head % static_cast<uint32_t>(width));
+            switch (player.dir)
+            {
+            case Direction::UP:
+                row--;
+                break;
+            case Direction::DOWN:
+                row++;
+                break;
+            case Direction::LEFT:
+                col--;
+                break;
+            case Direction::RIGHT:
+                col++;
+                break;
+            }
+
+            player.dying = row < 0 || row >= height || col < 0 || col >= width;
+            if (player.dying)
+                continue;
+            player.target = static_cast<uint32_t>(row) * static_cast<uint32_t>(width) + static_cast<uint32_t>(col);
+            if (cells[player.target] >= CELL_SNAKE)
+            {
+                player.dying = true;
+            }
+            else if (claimTick[player.target] == tick)
+            {
+                player.dying = true;
+                players[claimedBy[player.target]].dying = true;
+            }
+            else
+            {
+                claimTick[player.target] = tick;
+                claimedBy[player.target] = id;
+            }
+        }
+
+        for (uint16_t id = 0; id < count; ++id)
+        {
+            ArenaPlayer &player = players[id];
+            if (!player.alive)
+                continue;
+            if (player.dying)
+            {
+                kill(id);
+                continue;
+            }
+
+            if (cells[player.target] == CELL_FOOD)
+            {
+                player.score++;
+                foodOnBoard--;
+            }
+            else
+            {
+                set(player.body.pop_back(), CELL_EMPTY);
+            }
+            player.body.push_front(player.target);
+            set(player.target, static_cast<uint16_t>(CELL_SNAKE + id));
+        }
+
+        // Respawns go last so they can not land on a cell a head just claimed
+        for (uint16_t id = 0; id < count; ++id)
+        {
+            ArenaPlayer &player = players[id];
+            if (!player.alive && player.connected && tick >= player.respawnTick && !spawn(id))
+                player.respawnTick = tick + RESPAWN_TICKS;
+        }
+
+        spawnFood();
+    }
+
+    // Every non-empty cell, for a client joining mid-game.
+    void snapshot(std::vector<CellChange> &out) const
+    {
+        out.clear();
+        for (uint32_t cell = 0; cell < cells.size(); ++cell)
+        {
+            if (cells[cell] != CELL_EMPTY)
+                out.push_back({cell, cells[cell]});
+        }
+    }
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+// Autopilot: steers the snake toward the nearest food.
+//
+// The planner runs A* from the head to the closest item in foodPositions,
+// going around the snake and the walls, and keeps the resulting path. A
+// normal step only blocks the new head, which is the first cell of that
+// path, and frees the tail, which can not make the rest of the path any
+// worse, so the path is reused until food is eaten or it stops matching
+// the game (e.g. the player steered). A search that runs out of its
+// expansion budget, or finds every food walled off, settles for the path
+// to the cell it got closest to and searches again from there, so a tick
+// never costs more than one bounded search. Search state is stamped with a
+// per-search generation instead of being cleared, and every buffer is
+// sized once per board, so planning does not allocate.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "snake_engine.h"
+
+constexpr uint32_t NO_CELL = UINT32_MAX;
+constexpr uint32_t MAX_EXPANSIONS = 4096; // about 1 ms on a 1000x1000 board
+
+struct Autopilot
+{
+    struct OpenEntry
+    {
+        uint64_t key; // f in the high half, h in the low half: deeper first on ties
+        uint32_t cell;
+        bool operator>(const OpenEntry &other) const { return key > other.key; }
+    };
+
+    int width = 0, height = 0;
+
+    std::vector<uint32_t> gScore;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> seen; // == generation once gScore/parent are valid for this search
+    uint32_t generation = 0;
+    std::vector<OpenEntry> openSet;
+    std::vector<uint32_t> path; // next cell at the back
+
+    uint64_t searches = 0, expanded = 0;
+
+    template <typename F>
+    void forNeighbours(uint32_t cell, F f) const
+    {
+        uint32_t row = cell / static_cast<uint32_t>(width), col = cell % static_cast<uint32_t>(width);
+        if (row > 0)
+            f(cell - static_cast<uint32_t>(width), Direction::UP);
+        if (row + 1 < static_cast<uint32_t>(height))
+            f(cell + static_cast<uint32_t>(width), Direction::DOWN);
+        if (col > 0)
+            f(cell - 1, Direction::LEFT);
+        if (col + 1 < static_cast<uint32_t>(width))
+            f(cell + 1, Direction::RIGHT);
+    }
+
+    void resize(const GameState &game)
+    {
+        width = game.width;
+        height = game.height;
+        size_t area = static_cast<size_t>(width) * static_cast<size_t>(height);
+        gScore.assign(area, 0);
+        parent.assign(area, NO_CELL);
+        seen.assign(area, 0);
+        generation = 0;
+        openSet.reserve(4 * MAX_EXPANSIONS + 1); // at most four pushes per expansion
+        path.reserve(MAX_EXPANSIONS);
+        path.clear();
+    }
+
+    // Manhattan distance to the nearest food item; never overestimates.
+    static uint32_t heuristic(const GameState &game, uint32_t cell)
+    {
+        std::pair<int, int> pos = game.cellPos(cell);
+        int best = game.width + game.height;
+        for (const auto &food : game.foodPositions)
+            best = std::min(best, std::abs(food.first - pos.first) + std::abs(food.second - pos.second));
+        return static_cast<uint32_t>(best);
+    }
+
+    void tracePath(uint32_t from, uint32_t start)
+    {
+        for (uint32_t cell = from; cell != start; cell = parent[cell])
+            path.push_back(cell);
+    }
+
+    // Fills `path` with the shortest route from the head to any food, or a
+    // route to the closest cell reached if there is none within the budget.
+    // Returns false if the head can not get any closer.
+    bool search(const GameState &game, Direction current)
+    {
+        if (++generation == 0)
+        {
+            std::fill(seen.begin(), seen.end(), 0);
+            generation = 1;
+        }
+        searches++;
+        path.clear();
+        openSet.clear();
+
+        uint32_t start = game.snake.front();
+        seen[start] = generation;
+        gScore[start] = 0;
+        parent[start] = NO_CELL;
+        uint32_t h = heuristic(game, start);
+        openSet.push_back({static_cast<uint64_t>(h) << 32 | h, start});
+        uint32_t closest = start, closestH = h;
+
+        for (uint32_t budget = MAX_EXPANSIONS; !openSet.empty() && budget > 0; --budget)
+        {
+            std::pop_heap(openSet.begin(), openSet.end(), std::greater<OpenEntry>());
+            OpenEntry entry = openSet.back();
+            openSet.pop_back();
+            uint32_t u = entry.cell;
+            if ((entry.key >> 32) != gScore[u] + (entry.key & 0xFFFFFFFF))
+            {
+                budget++; // stale entry, u was reached more cheaply since
+                continue;
+            }
+            expanded++;
+
+            if (game.cells[u] == Cell::FOOD)
+            {
+                tracePath(u, start);
+                return true;
+            }
+            uint32_t hu = static_cast<uint32_t>(entry.key & 0xFFFFFFFF);
+            if (hu < closestH)
+            {
+                closest = u;
+                closestH = hu;
+            }
+
+            uint32_t g = gScore[u] + 1;
+            forNeighbours(u, [&](uint32_t n, Direction d)
+            {
+                // A one-segment snake has no neck to stop it reversing, but the turn queue does
+                if (game.cells[n] == Cell::SNAKE || (u == start && isReverse(current, d)))
+                    return;
+                if (seen[n] == generation && gScore[n] <= g)
+                    return;
+                seen[n] = generation;
+                gScore[n] = g;
+                parent[n] = u;
+                uint32_t hn = heuristic(game, n);
+                openSet.push_back({static_cast<uint64_t>(g + hn) << 32 | hn, n});
+                std::push_heap(openSet.begin(), openSet.end(), std::greater<OpenEntry>());
+            });
+        }
+
+        tracePath(closest, start);
+        return !path.empty();
+    }
+
+    // Forgets the old path. The buffers are sized by the first choose(), so
+    // a huge board that is never steered costs nothing here.
+    void reset(const GameState &)
+    {
+        path.clear();
+    }
+
+    // Keeps the planned path in step with the move the game just made.
+    void update(const GameState &game, const StepResult &result)
+    {
+        if (result.outcome == StepOutcome::MOVED && !path.empty() && path.back() == game.snake.front())
+            path.pop_back();
+        else
+            path.clear();
+    }
+
+    // Direction for the next tick: along the planned path, or any safe move
+    // (going straight if possible) when no food can be reached.
+    Direction choose(const GameState &game, Direction current)
+    {
+        if (game.width != width || game.height != height)
+            resize(game);
+
+        uint32_t head = game.snake.front();
+        Direction best = current;
+        bool found = false;
+        if (!path.empty() || search(game, current))
+        {
+            forNeighbours(head, [&](uint32_t n, Direction d)
+            {
+                if (n == path.back() && game.cells[n] != Cell::SNAKE)
+                {
+                    best = d;
+                    found = true;
+                }
+            });
+            if (found)
+                return best;
+            path.clear();
+        }
+
+        // No route to food: stay alive as long as possible
+        forNeighbours(head, [&](uint32_t n, Direction d)
+        {
+            if (game.cells[n] == Cell::SNAKE || isReverse(current, d))
+                return;
+            if (!found || d == current)
+                best = d;
+            found = true;
+        });
+        return best;
+    }
+};
@@ -0,0 +1,280 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "snake_engine.h"
+
+using namespace std;
+
+// Batch simulator: plays many independent headless games on a thread pool
+// and reports throughput and the score distribution.
+// Build: g++ -O2 -pthread snake_batch.cpp -o snake_batch
+//
+// Game i is always seeded with seed + i, so results do not depend on the
+// thread count or on which worker happened to run which game.
+
+struct BatchOptions
+{
+    int games = 10000;
+    int threads = static_cast<int>(thread::hardware_concurrency());
+    int width = 59, height = 20;
+    int foodCount = 1;
+    uint64_t seed = 1;
+    uint64_t maxTicks = 0; // per game, 0 = 100 x board area
+    bool scaling = false;
+};
+
+// Moves toward the nearest food, never into a wall or the snake if
+// there is any other choice.
+Direction greedyPolicy(const GameState &game, Direction current, Rng &rng)
+{
+    static const Direction options[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+    static const int dRow[] = {-1, 1, 0, 0};
+    static const int dCol[] = {0, 0, -1, 1};
+
+    pair<int, int> head = game.get_front();
+    Direction best = current;
+    int bestScore = -1;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (isReverse(current, options[i]))
+            continue;
+        int row = head.first + dRow[i], col = head.second + dCol[i];
+        if (!game.inBounds(row, col) || game.cellAt(row, col) == Cell::SNAKE)
+            continue;
+
+        int distance = game.width + game.height;
+        for (const auto &food : game.foodPositions)
+            distance = min(distance, abs(food.first - row) + abs(food.second - col));
+
+        // Closer is better; random low bits break ties
+        int score = (game.width + game.height - distance) * 4 + static_cast<int>(rng.below(4));
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = options[i];
+        }
+    }
+    return best;
+}
+
+// Per-worker results, padded so workers never share a cache line.
+struct alignas(64) WorkerStats
+{
+    uint64_t ticks = 0;
+    uint64_t games = 0;
+    uint64_t stolen = 0;
+};
+
+// Range of game ids [begin, end) owned by one worker, packed into one
+// 64-bit atomic so the owner (taking from the front) and thieves (taking
+// the back half) can both update it with a single CAS.
+struct alignas(64) WorkQueue
+{
+    atomic<uint64_t> range{0};
+
+    static uint64_t pack(uint32_t begin, uint32_t end) { return (static_cast<uint64_t>(begin) << 32) | end; }
+    static uint32_t beginOf(uint64_t r) { return static_cast<uint32_t>(r >> 32); }
+    static uint32_t endOf(uint64_t r) { return static_cast<uint32_t>(r); }
+
+    bool pop(uint32_t &game)
+    {
+        uint64_t r = range.load(memory_order_acquire);
+        while (beginOf(r) < endOf(r))
+        {
+            if (range.compare_exchange_weak(r, pack(beginOf(r) + 1, endOf(r)), memory_order_acq_rel))
+            {
+                game = beginOf(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Takes the back half of this queue's range.
+    bool steal(uint32_t &begin, uint32_t &end)
+    {
+        uint64_t r = range.load(memory_order_acquire);
+        while (beginOf(r) < endOf(r))
+        {
+            uint32_t count = endOf(r) - beginOf(r);
+            uint32_t take = (count + 1) / 2;
+            if (range.compare_exchange_weak(r, pack(beginOf(r), endOf(r) - take), memory_order_acq_rel))
+            {
+                begin = endOf(r) - take;
+                end = endOf(r);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+struct BatchResult
+{
+    vector<unsigned int> scores;
+    uint64_t ticks = 0;
+    uint64_t stolen = 0;
+    double seconds = 0;
+};
+
+BatchResult runBatch(const BatchOptions &options, int threads)
+{
+    BatchResult result;
+    result.scores.assign(static_cast<size_t>(options.games), 0);
+
+    vector<WorkQueue> queues(static_cast<size_t>(threads));
+    vector<WorkerStats> stats(static_cast<size_t>(threads));
+    for (int t = 0; t < threads; ++t)
+    {
+        uint32_t begin = static_cast<uint32_t>(static_cast<long>(options.games) * t / threads);
+        uint32_t end = static_cast<uint32_t>(static_cast<long>(options.games) * (t + 1) / threads);
+        queues[static_cast<size_t>(t)].range.store(WorkQueue::pack(begin, end));
+    }
+
+    uint64_t maxTicks = options.maxTicks ? options.maxTicks : 100ull * options.width * options.height;
+
+    auto worker = [&](int id)
+    {
+        GameState game;
+        Rng policyRng;
+        WorkerStats &mine = stats[static_cast<size_t>(id)];
+        WorkQueue &own = queues[static_cast<size_t>(id)];
+
+        while (true)
+        {
+            uint32_t index;
+            if (!own.pop(index))
+            {
+                // Out of work: steal the back half of someone else's range
+                bool found = false;
+                for (int k = 1; k < threads && !found; ++k)
+                {
+                    uint32_t begin, end;
+                    if (queues[static_cast<size_t>((id + k) % threads)].steal(begin, end))
+                    {
+                        own.range.store(WorkQueue::pack(begin, end), memory_order_release);
+                        mine.stolen += end - begin;
+                        found = true;
+                    }
+                }
+                if (!found)
+                    return;
+                continue;
+            }
+
+            uint64_t seed = options.seed + index;
+            game.reset(options.width, options.height, options.foodCount, seed);
+            policyRng.seed(~seed);
+            Direction dir = Direction::RIGHT;
+            uint64_t ticks = 0;
+            while (game.alive && ticks < maxTicks)
+            {
+                dir = greedyPolicy(game, dir, policyRng);
+                game.step(dir);
+                ticks++;
+            }
+
+            result.scores[index] = game.score;
+            mine.ticks += ticks;
+            mine.games++;
+        }
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(worker, t);
+    for (auto &th : pool)
+        th.join();
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    for (const auto &s : stats)
+    {
+        result.ticks += s.ticks;
+        result.stolen += s.stolen;
+    }
+    return result;
+}
+
+void printResult(const BatchOptions &options, int threads, BatchResult &result)
+{
+    vector<unsigned int> sorted = result.scores;
+    sort(sorted.begin(), sorted.end());
+    auto at = [&](double p) { return sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))]; };
+    double mean = 0;
+    for (unsigned int s : sorted)
+        mean += s;
+    mean /= static_cast<double>(sorted.size());
+
+    printf("%d games on %dx%d, %d thread(s): %.3f s\n", options.games, options.width, options.height, threads, result.seconds);
+    printf("  throughput: %.0f ticks/s, %.0f games/s (%llu ticks, %llu games stolen)\n",
+           static_cast<double>(result.ticks) / result.seconds, options.games / result.seconds,
+           static_cast<unsigned long long>(result.ticks), static_cast<unsigned long long>(result.stolen));
+    printf("  score: min %u  p50 %u  p90 %u  p99 %u  max %u  mean %.2f\n",
+           sorted.front(), at(0.50), at(0.90), at(0.99), sorted.back(), mean);
+}
+
+int main(int argc, char *argv[])
+{
+    BatchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--games" && hasValue)
+            options.games = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue)
+            options.threads = atoi(argv[++i]);
+        else if (arg == "--width" && hasValue)
+            options.width = atoi(argv[++i]);
+        else if (arg == "--height" && hasValue)
+            options.height = atoi(argv[++i]);
+        else if (arg == "--food" && hasValue)
+            options.foodCount = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-ticks" && hasValue)
+            options.maxTicks = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--scaling")
+            options.scaling = true;
+        else
+        {
+            fprintf(stderr, "usage: %s [--games N] [--threads T] [--width W] [--height H] [--food F]"
+                            " [--seed S] [--max-ticks M] [--scaling]\n", argv[0]);
+            return 1;
+        }
+    }
+    options.threads = max(1, options.threads);
+    if (options.games < 1 || options.width < 2 || options.height < 2 || options.foodCount < 1)
+    {
+        fprintf(stderr, "games, food must be >= 1 and the board at least 2x2\n");
+        return 1;
+    }
+
+    if (options.scaling)
+    {
+        // Same games at 1, 2, 4, ... threads to check how close to linear we get
+        double baseline = 0;
+        printf("%8s %14s %10s %10s\n", "threads", "ticks/s", "speedup", "efficiency");
+        for (int threads = 1; threads <= options.threads; threads *= 2)
+        {
+            BatchResult result = runBatch(options, threads);
+            double rate = static_cast<double>(result.ticks) / result.seconds;
+            if (threads == 1)
+                baseline = rate;
+            printf("%8d %14.0f %9.2fx %9.0f%%\n", threads, rate, rate / baseline, 100 * rate / baseline / threads);
+        }
+        return 0;
+    }
+
+    BatchResult result = runBatch(options, options.threads);
+    printResult(options, options.threads, result);
+    return 0;
+}
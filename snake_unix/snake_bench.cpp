@@ -0,0 +1,855 @@
+#include <iostream>
+#include <vector>
+#include <unordered_set>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "snake_engine.h"
+#include "snake_render.h"
+#include "snake_vecenv.h"
+#include "snake_world.h"
+#include "snake_solver.h"
+#include "snake_core.h"
+
+using namespace std;
+
+// Micro-benchmarks for the engine data structures.
+// Build: g++ -O2 snake_bench.cpp -o snake_bench
+// Usage: ./snake_bench [--micro] [--csv FILE]
+//   --micro     only the per-operation suite, not the old-vs-new comparisons
+//   --csv FILE  also write the per-operation suite as CSV, for diffing revisions
+
+// Every heap allocation in this process is counted, so the suite can
+// report allocations per operation next to the time.
+unsigned long allocationCount = 0;
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// The hash the game used for its unordered_set of snake cells.
+struct pairHash
+{
+    size_t operator()(const pair<int, int> &p) const
+    {
+        return hash<int>()(p.first) ^ (hash<int>()(p.second) << 1);
+    }
+};
+
+constexpr int BENCH_MOVES = 2000000;
+constexpr int BENCH_MAX_LENGTH = 1 << 16;
+
+// Cell k of a path that snakes left-right, right-left over the whole board.
+pair<int, int> serpentine(long k, int width, int height)
+{
+    long area = static_cast<long>(width) * height;
+    k %= area;
+    int row = static_cast<int>(k / width);
+    int col = static_cast<int>(k % width);
+    return {row, (row % 2 == 0) ? col : width - 1 - col};
+}
+
+// Walks a snake of `length` segments along the serpentine path and
+// returns nanoseconds per move (collision check + insert head + erase tail).
+template <typename Occupancy>
+double benchOccupancy(Occupancy &occ, int width, int height, int length, long &collisions)
+{
+    for (int i = 0; i < length; ++i)
+        occ.insert(serpentine(i, width, height));
+
+    auto start = chrono::steady_clock::now();
+    for (long k = length; k < length + BENCH_MOVES; ++k)
+    {
+        pair<int, int> newHead = serpentine(k, width, height);
+        if (occ.contains(newHead))
+            collisions++;
+        occ.insert(newHead);
+        occ.erase(serpentine(k - length, width, height));
+    }
+    auto elapsed = chrono::steady_clock::now() - start;
+    return chrono::duration<double, nano>(elapsed).count() / BENCH_MOVES;
+}
+
+struct SetOccupancy
+{
+    unordered_set<pair<int, int>, pairHash> cells;
+    bool contains(pair<int, int> p) const { return cells.count(p) != 0; }
+    void insert(pair<int, int> p) { cells.insert(p); }
+    void erase(pair<int, int> p) { cells.erase(p); }
+};
+
+struct GridOccupancy
+{
+    int width;
+    vector<Cell> cells;
+    GridOccupancy(int w, int h) : width(w), cells(static_cast<size_t>(w) * h, Cell::EMPTY) {}
+    size_t index(pair<int, int> p) const { return static_cast<size_t>(p.first) * width + p.second; }
+    bool contains(pair<int, int> p) const { return cells[index(p)] == Cell::SNAKE; }
+    void insert(pair<int, int> p) { cells[index(p)] = Cell::SNAKE; }
+    void erase(pair<int, int> p) { cells[index(p)] = Cell::EMPTY; }
+};
+
+void benchCollisionCheck()
+{
+    const pair<int, int> boards[] = {{60, 20}, {256, 256}, {1024, 1024}, {4096, 4096}};
+
+    printf("%-12s %8s %14s %14s %8s\n", "board", "length", "set ns/move", "grid ns/move", "speedup");
+    for (const auto &board : boards)
+    {
+        int width = board.first, height = board.second;
+        int length = min(width * height / 2, BENCH_MAX_LENGTH);
+        long collisions = 0;
+
+        SetOccupancy set;
+        double setNs = benchOccupancy(set, width, height, length, collisions);
+
+        GridOccupancy grid(width, height);
+        double gridNs = benchOccupancy(grid, width, height, length, collisions);
+
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", width, height);
+        printf("%-12s %8d %14.2f %14.2f %7.1fx\n", name, length, setNs, gridNs, setNs / gridNs);
+        if (collisions)
+            printf("  unexpected collisions: %ld\n", collisions);
+    }
+}
+
+// The --infinite store: chunks from a pool, found through a packed-key table.
+struct ChunkOccupancy
+{
+    ChunkWorld world;
+    bool contains(pair<int, int> p) const { return world.cellAt(p.first, p.second) == Cell::SNAKE; }
+    void insert(pair<int, int> p) { world.set(p, Cell::SNAKE); }
+    void erase(pair<int, int> p) { world.set(p, Cell::EMPTY); }
+};
+
+// A snake travelling BENCH_MOVES cells down an endless serpentine strip:
+// the old hashed set against the chunked world, and how many chunks the
+// world holds at the end (it should follow the length, not the distance).
+void benchSparseWorld()
+{
+    const int stripWidth = 256, stripHeight = 1 << 22;
+    const int lengths[] = {100, 10000, 1000000};
+
+    printf("\n%-8s %14s %14s %8s %12s %12s\n", "length", "set ns/move", "chunk ns/move", "speedup", "live chunks", "pool chunks");
+    for (int length : lengths)
+    {
+        long collisions = 0;
+        SetOccupancy set;
+        double setNs = benchOccupancy(set, stripWidth, stripHeight, length, collisions);
+
+        ChunkOccupancy chunks;
+        double chunkNs = benchOccupancy(chunks, stripWidth, stripHeight, length, collisions);
+
+        printf("%-8d %14.2f %14.2f %7.1fx %12zu %12zu\n", length, setNs, chunkNs, setNs / chunkNs,
+               chunks.world.liveChunks(), chunks.world.pool.size());
+        if (collisions)
+            printf("  unexpected collisions: %ld\n", collisions);
+    }
+}
+
+// Number of write() syscalls this process has made so far (Linux only).
+long writeSyscalls()
+{
+    ifstream io("/proc/self/io");
+    string key;
+    long value;
+    while (io >> key >> value)
+    {
+        if (key == "syscw:")
+            return value;
+    }
+    return -1;
+}
+
+constexpr int FRAME_BENCH_FRAMES = 1000;
+constexpr int FRAME_BENCH_SIZE = 100; // square screen the snake walks on
+
+// The old per-tick output path: printf/cout into a line-buffered stdout
+// (as on a tty), with drawSnake() repainting every segment and flushing,
+// then drawSidebar() flushing again. Returns the bytes produced.
+long legacyFrame(FILE *out, long tick, int length)
+{
+    long bytes = 0;
+    pair<int, int> vacated = serpentine(tick - length, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+    bytes += fprintf(out, "\033[%d;%dH ", vacated.first + 1, vacated.second + 1);
+
+    for (int i = 0; i < length; ++i)
+    {
+        pair<int, int> pos = serpentine(tick - i, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+        bytes += fprintf(out, "\033[%d;%dH\033[32mS\033[0m", pos.first + 1, pos.second + 1);
+    }
+    fflush(out);
+
+    bytes += fprintf(out, "\033[%d;%dH\033[36m=== INFO ===\033[0m", 1, 2);
+    bytes += fprintf(out, "\033[%d;%dHScore: %d", 3, 2, length);
+    bytes += fprintf(out, "\033[%d;%dHTime: %02d:%02d", 5, 2, 0, 0);
+    fflush(out);
+    return bytes;
+}
+
+void frameBufferFrame(FrameBuffer &fb, FrameOutput &out, int fd, long tick, int length)
+{
+    pair<int, int> vacated = serpentine(tick - length, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+    pair<int, int> newHead = serpentine(tick, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+    fb.put(vacated.first + 1, vacated.second + 1, ' ');
+    fb.put(newHead.first + 1, newHead.second + 1, 'S', 1);
+
+    fb.text(1, 2, "=== INFO ===", 2);
+    fb.text(3, 2, "Score: " + to_string(length));
+    fb.text(5, 2, "Time: 00:00");
+
+    out.begin();
+    fb.present(out.bytes);
+    out.flush(fd);
+}
+
+// Counts write() syscalls and bytes per frame for the old stdio output
+// path and for FrameBuffer + FrameOutput, both sent to /dev/null.
+void benchFrameSyscalls()
+{
+    const int lengths[] = {10, 100, 1000};
+
+    printf("\n%-8s %16s %16s %16s %16s\n", "length", "old writes/frame", "new writes/frame", "old bytes/frame", "new bytes/frame");
+    for (int length : lengths)
+    {
+        FILE *legacy = fopen("/dev/null", "w");
+        setvbuf(legacy, nullptr, _IOLBF, 1024);
+        long legacyBytes = 0;
+        long before = writeSyscalls();
+        for (long tick = length; tick < length + FRAME_BENCH_FRAMES; ++tick)
+            legacyBytes += legacyFrame(legacy, tick, length);
+        long legacyWrites = writeSyscalls() - before;
+        fclose(legacy);
+
+        int fd = open("/dev/null", O_WRONLY);
+        FrameBuffer fb;
+        fb.resize(FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+        fb.styles = {"", "\033[32m", "\033[36m"};
+        FrameOutput out;
+        for (int i = 0; i < length; ++i)
+        {
+            pair<int, int> pos = serpentine(i, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+            fb.put(pos.first + 1, pos.second + 1, 'S', 1);
+        }
+        out.begin();
+        fb.present(out.bytes);
+        out.flush(fd);
+
+        unsigned long bytesBefore = out.bytesWritten;
+        before = writeSyscalls();
+        for (long tick = length; tick < length + FRAME_BENCH_FRAMES; ++tick)
+            frameBufferFrame(fb, out, fd, tick, length);
+        long newWrites = writeSyscalls() - before;
+        unsigned long newBytes = out.bytesWritten - bytesBefore;
+        close(fd);
+
+        printf("%-8d %16.2f %16.2f %16.1f %16.1f\n", length,
+               static_cast<double>(legacyWrites) / FRAME_BENCH_FRAMES,
+               static_cast<double>(newWrites) / FRAME_BENCH_FRAMES,
+               static_cast<double>(legacyBytes) / FRAME_BENCH_FRAMES,
+               static_cast<double>(newBytes) / FRAME_BENCH_FRAMES);
+    }
+}
+
+// FrameBuffer::present() as it was before the pen was cached: every run
+// switched styles for its blanks too and reset to the default at its end.
+void presentResettingRuns(FrameBuffer &fb, string &out)
+{
+    for (int row = 0; row < fb.rows; ++row)
+    {
+        const size_t rowStart = static_cast<size_t>(row) * fb.cols;
+        int col = 0;
+        while (col < fb.cols)
+        {
+            if (fb.back[rowStart + col] == fb.front[rowStart + col])
+            {
+                col++;
+                continue;
+            }
+
+            int last = col;
+            for (int next = col + 1; next < fb.cols && next - last <= RUN_GAP; ++next)
+            {
+                if (fb.back[rowStart + next] != fb.front[rowStart + next])
+                    last = next;
+            }
+
+            FrameBuffer::appendCursorMove(out, row + 1, col + 1);
+            uint8_t current = 0;
+            for (int c = col; c <= last; ++c)
+            {
+                const ScreenCell &cell = fb.back[rowStart + c];
+                if (cell.style != current)
+                {
+                    if (current != 0)
+                        out += "\033[0m";
+                    out += fb.styles[cell.style];
+                    current = cell.style;
+                }
+                out += cell.ch;
+                fb.front[rowStart + c] = cell;
+            }
+            if (current != 0)
+                out += "\033[0m";
+            col = last + 1;
+        }
+    }
+}
+
+constexpr int SGR_BENCH_ROWS = 200; // tall enough for a 10000 segment coil
+constexpr int SGR_BENCH_COLS = 100;
+
+// Cell k of a path that runs down and up every other column, turning
+// through the column between, so each row crosses the snake with a blank
+// between passes like a coiled snake does.
+pair<int, int> coil(long k, int width, int height)
+{
+    long period = height + 1; // one column plus the turn into the next
+    long pass = (k / period) % (width / 2);
+    long step = k % period;
+    bool down = pass % 2 == 0;
+    if (step < height)
+        return {static_cast<int>(down ? step : height - 1 - step), static_cast<int>(2 * pass)};
+    return {down ? height - 1 : 0, static_cast<int>(2 * pass + 1)};
+}
+
+// Bytes per frame for a `length` segment snake: a tick (head and tail
+// move, sidebar text) and a redraw of the whole screen, as after a camera
+// scroll or the pause menu. Compares a colour escape around every segment
+// as drawSnake() wrote it, a reset at the end of every run, and the pen
+// FrameBuffer now keeps across runs, on a serpentine and on a coil.
+void benchSgrCaching()
+{
+    const int lengths[] = {100, 1000, 10000};
+    struct Shape
+    {
+        const char *name;
+        pair<int, int> (*path)(long, int, int);
+    };
+    const Shape shapes[] = {{"rows", serpentine}, {"coil", coil}};
+
+    printf("\n%-7s %-5s %12s %13s %13s %13s %13s %7s\n", "length", "shape", "per segment",
+           "tick/reset", "tick/pen", "redraw/reset", "redraw/pen", "saved");
+    for (int length : lengths)
+    {
+        for (const Shape &shape : shapes)
+        {
+            auto cellOf = [&](long k) { return shape.path(k, SGR_BENCH_COLS, SGR_BENCH_ROWS); };
+
+            // Every segment with its own colour and reset, as drawSnake() wrote them
+            long perSegment = 0;
+            for (long tick = length; tick < length + FRAME_BENCH_FRAMES; ++tick)
+            {
+                string frame;
+                for (int i = 0; i < length; ++i)
+                {
+                    pair<int, int> pos = cellOf(tick - i);
+                    FrameBuffer::appendCursorMove(frame, pos.first + 1, pos.second + 1);
+                    frame += "\033[32mS\033[0m";
+                }
+                perSegment += static_cast<long>(frame.size());
+            }
+
+            // Same frames through both presents, one framebuffer each
+            FrameBuffer resetting, cached;
+            for (FrameBuffer *fb : {&resetting, &cached})
+            {
+                fb->resize(SGR_BENCH_ROWS, SGR_BENCH_COLS);
+                fb->styles = {"", "\033[32m", "\033[36m"};
+            }
+            auto drawFrame = [&](FrameBuffer &fb, long tick)
+            {
+                pair<int, int> vacated = cellOf(tick - length);
+                fb.put(vacated.first + 1, vacated.second + 1, ' ');
+                for (int i = 0; i < length; ++i)
+                {
+                    pair<int, int> pos = cellOf(tick - i);
+                    fb.put(pos.first + 1, pos.second + 1, 'S', 1);
+                }
+                fb.text(1, 2, "=== INFO ===", 2);
+                fb.text(3, 2, "Score: " + to_string(tick));
+            };
+
+            string out;
+            long resettingTick = 0, cachedTick = 0;
+            for (long tick = length; tick < length + FRAME_BENCH_FRAMES; ++tick)
+            {
+                drawFrame(resetting, tick);
+                out.clear();
+                presentResettingRuns(resetting, out);
+                if (tick > length) // the first frame draws the whole snake
+                    resettingTick += static_cast<long>(out.size());
+
+                drawFrame(cached, tick);
+                out.clear();
+                cached.present(out);
+                if (tick > length)
+                    cachedTick += static_cast<long>(out.size());
+            }
+
+            resetting.invalidate();
+            out.clear();
+            presentResettingRuns(resetting, out);
+            size_t resettingRedraw = out.size();
+            cached.invalidate();
+            out.clear();
+            cached.present(out);
+            size_t cachedRedraw = out.size();
+
+            double ticks = FRAME_BENCH_FRAMES - 1;
+            printf("%-7d %-5s %12.1f %13.1f %13.1f %13zu %13zu %6.1f%%\n", length, shape.name,
+                   static_cast<double>(perSegment) / FRAME_BENCH_FRAMES, resettingTick / ticks, cachedTick / ticks,
+                   resettingRedraw, cachedRedraw, 100.0 * (1.0 - static_cast<double>(cachedRedraw) / resettingRedraw));
+        }
+    }
+}
+
+constexpr int VECENV_COUNT = 4096;
+constexpr int VECENV_BATCHES = 2000;
+
+// Random actions that never reverse into the neck, same stream for both runs.
+void nextActions(Rng &rng, vector<uint8_t> &actions, vector<uint8_t> &last, const uint8_t *dones)
+{
+    for (size_t e = 0; e < actions.size(); ++e)
+    {
+        if (dones && dones[e])
+            last[e] = static_cast<uint8_t>(Direction::RIGHT);
+        uint8_t a = static_cast<uint8_t>(rng.below(4));
+        if (a == (last[e] ^ 1))
+            a = last[e];
+        actions[e] = a;
+        last[e] = a;
+    }
+}
+
+// Env-steps per second for VectorEnv::step_batch against stepping the
+// same number of GameState instances one by one.
+void benchVectorEnv()
+{
+    const pair<int, int> boards[] = {{16, 16}, {59, 20}};
+
+    printf("\n%-8s %6s %18s %18s %8s\n", "board", "envs", "scalar steps/s", "batched steps/s", "speedup");
+    for (const auto &board : boards)
+    {
+        int width = board.first, height = board.second;
+        vector<uint8_t> actions(VECENV_COUNT), last(VECENV_COUNT), dones(VECENV_COUNT, 0);
+        vector<float> rewards(VECENV_COUNT);
+
+        vector<GameState> games(VECENV_COUNT);
+        for (int e = 0; e < VECENV_COUNT; ++e)
+            games[static_cast<size_t>(e)].reset(width, height, 1, static_cast<uint64_t>(e));
+        Rng actionRng;
+        actionRng.seed(42);
+        fill(last.begin(), last.end(), static_cast<uint8_t>(Direction::RIGHT));
+
+        auto start = chrono::steady_clock::now();
+        for (int b = 0; b < VECENV_BATCHES; ++b)
+        {
+            nextActions(actionRng, actions, last, dones.data());
+            for (int e = 0; e < VECENV_COUNT; ++e)
+            {
+                GameState &game = games[static_cast<size_t>(e)];
+                StepResult result = game.step(static_cast<Direction>(actions[static_cast<size_t>(e)]));
+                rewards[static_cast<size_t>(e)] = result.outcome == StepOutcome::ATE ? REWARD_FOOD : result.outcome == StepOutcome::DIED ? REWARD_DEATH : 0.0f;
+                dones[static_cast<size_t>(e)] = !game.alive;
+                if (!game.alive)
+                    game.reset(width, height, 1, static_cast<uint64_t>(b) * VECENV_COUNT + e);
+            }
+        }
+        double scalarSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        VectorEnv env;
+        env.init(VECENV_COUNT, width, height, 0);
+        actionRng.seed(42);
+        fill(last.begin(), last.end(), static_cast<uint8_t>(Direction::RIGHT));
+        fill(dones.begin(), dones.end(), 0);
+
+        start = chrono::steady_clock::now();
+        for (int b = 0; b < VECENV_BATCHES; ++b)
+        {
+            nextActions(actionRng, actions, last, dones.data());
+            env.step_batch(actions.data(), rewards.data(), dones.data());
+        }
+        double batchSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double steps = static_cast<double>(VECENV_COUNT) * VECENV_BATCHES;
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", width, height);
+        printf("%-8s %6d %18.0f %18.0f %7.1fx\n", name, VECENV_COUNT, steps / scalarSeconds, steps / batchSeconds, scalarSeconds / batchSeconds);
+    }
+}
+
+constexpr int VECENV_CHECK_ENVS = 1024;
+constexpr int VECENV_CHECK_TICKS = 200;
+
+// Feeds VectorEnv and GameState the same random actions, reversals
+// included, with each game's turn going through a TurnQueue as a key
+// would. Heads, directions and deaths must agree until an env first eats;
+// the two place food differently after that. Returns false on a mismatch.
+bool checkVectorEnvRules()
+{
+    const int width = 16, height = 16;
+    VectorEnv env;
+    env.init(VECENV_CHECK_ENVS, width, height, 0);
+    vector<GameState> games(VECENV_CHECK_ENVS);
+    vector<Direction> dirs(VECENV_CHECK_ENVS, Direction::RIGHT);
+    vector<uint8_t> comparing(VECENV_CHECK_ENVS, 1);
+    for (int e = 0; e < VECENV_CHECK_ENVS; ++e)
+        games[static_cast<size_t>(e)].reset(width, height, 1, static_cast<uint64_t>(e));
+
+    vector<uint8_t> actions(VECENV_CHECK_ENVS), dones(VECENV_CHECK_ENVS);
+    vector<float> rewards(VECENV_CHECK_ENVS);
+    Rng actionRng;
+    actionRng.seed(11);
+    long compared = 0, mismatches = 0;
+    for (int t = 0; t < VECENV_CHECK_TICKS; ++t)
+    {
+        for (uint8_t &action : actions)
+            action = static_cast<uint8_t>(actionRng.below(4));
+        env.step_batch(actions.data(), rewards.data(), dones.data());
+
+        for (size_t e = 0; e < actions.size(); ++e)
+        {
+            if (!comparing[e])
+                continue;
+            TurnQueue turns;
+            turns.push(dirs[e], static_cast<Direction>(actions[e]));
+            turns.pop(dirs[e]);
+            StepResult result = games[e].step(dirs[e]);
+            if (result.outcome == StepOutcome::ATE || rewards[e] == REWARD_FOOD)
+            {
+                comparing[e] = 0;
+                continue;
+            }
+
+            compared++;
+            bool died = result.outcome == StepOutcome::DIED;
+            pair<int, int> envHead = {env.headRow[e], env.headCol[e]};
+            bool differs = died != (rewards[e] == REWARD_DEATH) ||
+                           (!died && (envHead != games[e].get_front() || env.dir[e] != static_cast<uint8_t>(dirs[e])));
+            mismatches += differs;
+            if (died || differs)
+                comparing[e] = 0;
+        }
+    }
+    printf("\nvecenv vs engine: %ld env-steps compared, %ld differ\n", compared, mismatches);
+    return mismatches == 0;
+}
+
+constexpr int SWEEP_SIZE = 12;
+constexpr int SWEEP_MAX_FOOD = 3;
+constexpr int SWEEP_SEEDS = 200;
+
+// Lets the solver play every board up to SWEEP_SIZE x SWEEP_SIZE that has
+// a Hamiltonian cycle, with several food counts and seeds, the way
+// --solver --headless does. Small boards with a lot of food are where a
+// shortcut rule that lets the head eat its way into the tail shows up.
+// Returns false if any game did not fill its board.
+bool benchSolverSweep()
+{
+    long games = 0, failed = 0;
+    auto start = chrono::steady_clock::now();
+    for (int width = 2; width <= SWEEP_SIZE; ++width)
+    {
+        for (int height = 2; height <= SWEEP_SIZE; ++height)
+        {
+            HamiltonianSolver solver;
+            if (!solver.build(width, height))
+                continue;
+            for (int food = 1; food <= SWEEP_MAX_FOOD; ++food)
+            {
+                for (int seed = 0; seed < SWEEP_SEEDS; ++seed)
+                {
+                    GameState game;
+                    game.reset(width, height, food, static_cast<uint64_t>(seed));
+                    Direction dir = solver.onward[game.snake.front()];
+                    TurnQueue turns;
+                    while (game.alive && game.length() < solver.area)
+                    {
+                        turns.push(dir, solver.choose(game, dir));
+                        turns.pop(dir);
+                        game.step(dir);
+                    }
+                    games++;
+                    if (game.length() < solver.area)
+                    {
+                        if (failed++ < 5)
+                            printf("solver died: %dx%d, food %d, seed %d, length %zu/%u\n", width, height, food, seed,
+                                   game.length(), solver.area);
+                    }
+                }
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("\nsolver sweep: %ld games on boards up to %dx%d, %ld did not fill (%.2f s)\n", games, SWEEP_SIZE, SWEEP_SIZE,
+           failed, seconds);
+    return failed == 0;
+}
+
+constexpr int MICRO_REPEATS = 5;
+
+struct MicroResult
+{
+    string name;
+    long ops;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+vector<MicroResult> microResults;
+volatile uint64_t microSink = 0; // results fold in here so the optimizer keeps the work
+
+// Runs body(ops) MICRO_REPEATS times and keeps the fastest run, the one
+// least disturbed by the rest of the machine. Setup belongs outside body.
+template <typename Body>
+void measureMicro(const string &name, long ops, Body body)
+{
+    MicroResult result = {name, ops, 1e300, 1e300};
+    for (int r = 0; r < MICRO_REPEATS; ++r)
+    {
+        unsigned long allocationsBefore = allocationCount;
+        auto start = chrono::steady_clock::now();
+        body(ops);
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        result.nsPerOp = min(result.nsPerOp, ns / ops);
+        result.allocsPerOp = min(result.allocsPerOp, static_cast<double>(allocationCount - allocationsBefore) / ops);
+    }
+    printf("%-28s %10ld %12.2f %14.4f\n", name.c_str(), ops, result.nsPerOp, result.allocsPerOp);
+    microResults.push_back(result);
+}
+
+// GameState::step(), the engine half of updateSnake(), following the cycle.
+void microStep(int width, int height)
+{
+    HamiltonianSolver solver;
+    solver.build(width, height);
+    GameState game;
+    game.reset(width, height, 1, 1);
+    measureMicro("step/" + to_string(width) + "x" + to_string(height), 2000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+        {
+            StepResult result = game.step(solver.onward[game.snake.front()]);
+            if (result.outcome == StepOutcome::DIED)
+                game.reset(width, height, 1, static_cast<uint64_t>(i));
+            microSink += game.snake.front();
+        }
+    });
+}
+
+// Presses the key that keeps a GameCore on the solver's cycle.
+struct CycleInput
+{
+    const HamiltonianSolver *solver = nullptr;
+    const GameState *game = nullptr;
+
+    template <typename F>
+    void poll(F &&onKey)
+    {
+        static const char keys[] = {'w', 's', 'a', 'd'}; // in Direction order
+        onKey(keys[static_cast<int>(solver->onward[game->snake.front()])]);
+    }
+};
+
+// A whole GameCore::tick() with the null terminal and clock: the loop
+// every build shares, without any platform cost.
+void microCoreTick(int width, int height)
+{
+    HamiltonianSolver solver;
+    solver.build(width, height);
+    GameCore<NullTerminal, NullClock, CycleInput> core;
+    core.input.solver = &solver;
+    core.input.game = &core.game;
+    core.reset(width, height, 1, 1);
+    measureMicro("core_tick/" + to_string(width) + "x" + to_string(height), 2000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+        {
+            core.tick();
+            if (!core.running)
+                core.reset(width, height, 1, static_cast<uint64_t>(i));
+        }
+        microSink += core.terminal.cells;
+    });
+}
+
+// One push_front and one pop_back on a ring holding `length` segments.
+void microRing(int length)
+{
+    SnakeRing ring;
+    for (int i = 0; i < length; ++i)
+        ring.push_front(static_cast<uint32_t>(i));
+    measureMicro("ring_push_pop/" + to_string(length), 20000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+        {
+            ring.push_front(static_cast<uint32_t>(i));
+            microSink += ring.pop_back();
+        }
+    });
+}
+
+// spawnFood() placing one item on a 256x256 board with `percent` of the
+// cells taken by the snake; the item is taken away again after each op.
+void microSpawnFood(int percent)
+{
+    const int size = 256;
+    GameState game;
+    game.reset(size, size, 1, 1);
+    size_t target = static_cast<size_t>(size) * size * static_cast<size_t>(percent) / 100;
+    while (game.length() + game.foodPositions.size() < target && !game.freeCells.empty())
+    {
+        uint32_t index = game.freeCells[game.rng.below(static_cast<uint32_t>(game.freeCells.size()))];
+        game.snake.push_front(index);
+        game.markUsed(index, Cell::SNAKE);
+    }
+
+    measureMicro("spawn_food/fill" + to_string(percent), 5000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+        {
+            pair<int, int> food = game.foodPositions.back();
+            game.foodPositions.pop_back();
+            game.markFree(game.cellIndex(food));
+            game.spawnFood();
+            microSink += game.foodPositions.back().second;
+        }
+    });
+}
+
+// Membership tests against `length` snake cells, half of them hits: the
+// old unordered_set with pairHash, and the occupancy grid that replaced it.
+void microLookup(int length)
+{
+    const int width = 1024, height = 1024;
+    vector<pair<int, int>> probes;
+    Rng rng;
+    rng.seed(7);
+    for (int i = 0; i < 4096; ++i)
+        probes.push_back(serpentine(static_cast<long>(rng.below(static_cast<uint32_t>(2 * length))), width, height));
+
+    SetOccupancy set;
+    GridOccupancy grid(width, height);
+    for (int i = 0; i < length; ++i)
+    {
+        set.insert(serpentine(i, width, height));
+        grid.insert(serpentine(i, width, height));
+    }
+
+    measureMicro("pairhash_lookup/" + to_string(length), 1000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+            microSink += set.contains(probes[static_cast<size_t>(i) & 4095]);
+    });
+    measureMicro("grid_lookup/" + to_string(length), 1000000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i)
+            microSink += grid.contains(probes[static_cast<size_t>(i) & 4095]);
+    });
+}
+
+// Drawing a `length` segment snake one move further into a FrameBuffer,
+// as drawSnake() did every tick, and presenting it into a string.
+void microDrawSnake(int length)
+{
+    FrameBuffer fb;
+    fb.resize(FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+    fb.styles = {"", "\033[32m"};
+    string sink;
+    long tick = length;
+    measureMicro("draw_snake/" + to_string(length), 20000, [&](long ops)
+    {
+        for (long i = 0; i < ops; ++i, ++tick)
+        {
+            pair<int, int> vacated = serpentine(tick - length, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+            fb.put(vacated.first + 1, vacated.second + 1, ' ');
+            for (int s = 0; s < length; ++s)
+            {
+                pair<int, int> pos = serpentine(tick - s, FRAME_BENCH_SIZE, FRAME_BENCH_SIZE);
+                fb.put(pos.first + 1, pos.second + 1, 'S', 1);
+            }
+            sink.clear();
+            fb.present(sink);
+            microSink += sink.size();
+        }
+    });
+}
+
+// One engine or render operation at a time, reported as ns/op and heap
+// allocations/op.
+void benchMicro(const string &csvPath)
+{
+    printf("%-28s %10s %12s %14s\n", "benchmark", "ops", "ns/op", "allocs/op");
+    microStep(59, 20);
+    microStep(256, 256);
+    microCoreTick(59, 20);
+    microRing(1000);
+    microRing(1000000);
+    for (int percent : {10, 50, 90, 99})
+        microSpawnFood(percent);
+    microLookup(1000);
+    microLookup(100000);
+    microDrawSnake(100);
+    microDrawSnake(1000);
+
+    if (csvPath.empty())
+        return;
+    FILE *csv = fopen(csvPath.c_str(), "w");
+    if (!csv)
+    {
+        fprintf(stderr, "Could not write %s\n", csvPath.c_str());
+        return;
+    }
+    fprintf(csv, "benchmark,ops,ns_per_op,allocs_per_op\n");
+    for (const MicroResult &result : microResults)
+        fprintf(csv, "%s,%ld,%.3f,%.4f\n", result.name.c_str(), result.ops, result.nsPerOp, result.allocsPerOp);
+    fclose(csv);
+}
+
+int main(int argc, char *argv[])
+{
+    bool microOnly = false;
+    string csvPath;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--micro")
+            microOnly = true;
+        else if (arg == "--csv" && i + 1 < argc)
+            csvPath = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--micro] [--csv FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    benchMicro(csvPath);
+    if (microOnly)
+        return 0;
+
+    printf("\n");
+    benchCollisionCheck();
+    benchFrameSyscalls();
+    benchSgrCaching();
+    benchVectorEnv();
+    benchSparseWorld();
+    bool rulesMatch = checkVectorEnvRules();
+    bool solverFills = benchSolverSweep();
+    return rulesMatch && solverFills ? 0 : 1;
+}
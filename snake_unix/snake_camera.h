@@ -0,0 +1,96 @@
+#pragma once
+
+// Camera: which part of the board is on screen, and where.
+//
+// The board lives in its own coordinates (row 0..height-1, column
+// 0..width-1). The camera shows a window of it that fits the terminal
+// next to the sidebar, and maps board cells inside that window to 1-based
+// screen positions. When the board fits, the window is the whole board
+// and nothing ever scrolls. When it does not, follow() re-centres the
+// window on the head whenever the head gets within a quarter of the
+// window from an edge, so redrawing the window only happens every few
+// dozen moves and always costs the window's size, never the board's.
+// An unbounded board (--infinite) has no edges to clamp the window to.
+
+#include <algorithm>
+#include <utility>
+
+constexpr int SIDEBAR_COLUMNS = 19; // kept clear on both sides of the centred board
+
+struct Camera
+{
+    bool bounded = true;
+    int boardRows = 0, boardCols = 0;
+    int viewRows = 0, viewCols = 0;     // visible window, at most the board
+    int originRow = 0, originCol = 0;   // board cell at the window's top-left
+    int screenTop = 1, screenLeft = 1;  // screen cell showing the window's top-left
+
+    // Fits the window into a terminal of termRows x termCols, leaving a
+    // line above and below and a column either side for the border. A
+    // board size of 0 means the board is unbounded.
+    void layout(int boardWidth, int boardHeight, int termRows, int termCols)
+    {
+        bounded = boardWidth > 0 && boardHeight > 0;
+        boardRows = boardHeight;
+        boardCols = boardWidth;
+        viewRows = std::max(1, termRows - 2);
+        viewCols = std::max(1, termCols - 2 * SIDEBAR_COLUMNS - 2);
+        if (bounded)
+        {
+            viewRows = std::min(viewRows, boardRows);
+            viewCols = std::min(viewCols, boardCols);
+        }
+
+        // Same centring the fixed-size board always used
+        screenTop = (termRows - viewRows) / 2;
+        screenLeft = (termCols - viewCols - 1) / 2 + 1;
+        screenTop = std::max(screenTop, 2);
+        screenLeft = std::max(screenLeft, 2);
+        clamp();
+    }
+
+    void clamp()
+    {
+        if (!bounded)
+            return;
+        originRow = std::max(0, std::min(originRow, boardRows - viewRows));
+        originCol = std::max(0, std::min(originCol, boardCols - viewCols));
+    }
+
+    // Moves the window so `cell` is comfortably inside it. Returns true if
+    // the window moved and has to be redrawn.
+    bool follow(std::pair<int, int> cell)
+    {
+        int marginRows = viewRows / 4, marginCols = viewCols / 4;
+        int row = cell.first - originRow, col = cell.second - originCol;
+        int oldRow = originRow, oldCol = originCol;
+        if (row < marginRows || row >= viewRows - marginRows)
+            originRow = cell.first - viewRows / 2;
+        if (col < marginCols || col >= viewCols - marginCols)
+            originCol = cell.second - viewCols / 2;
+        clamp();
+        return originRow != oldRow || originCol != oldCol;
+    }
+
+    void centreOn(std::pair<int, int> cell)
+    {
+        originRow = cell.first - viewRows / 2;
+        originCol = cell.second - viewCols / 2;
+        clamp();
+    }
+
+    bool visible(std::pair<int, int> cell) const
+    {
+        return cell.first >= originRow && cell.first < originRow + viewRows &&
+               cell.second >= originCol && cell.second < originCol + viewCols;
+    }
+
+    int screenRow(int row) const { return screenTop + row - originRow; }
+    int screenCol(int col) const { return screenLeft + col - originCol; }
+
+    // Whether the board carries on past each edge of the window.
+    bool moreAbove() const { return !bounded || originRow > 0; }
+    bool moreBelow() const { return !bounded || originRow + viewRows < boardRows; }
+    bool moreLeft() const { return !bounded || originCol > 0; }
+    bool moreRight() const { return !bounded || originCol + viewCols < boardCols; }
+};
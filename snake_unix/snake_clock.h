@@ -0,0 +1,90 @@
+#pragma once
+
+// Fixed-timestep game clock.
+//
+// Ticks are scheduled on absolute deadlines (start + n * period) and slept
+// for with clock_nanosleep(TIMER_ABSTIME), so time spent updating and
+// rendering does not stretch the tick period. When the loop falls behind,
+// wait() reports how many ticks are due so the caller can catch up, up to
+// MAX_CATCH_UP_TICKS; anything beyond that is skipped.
+//
+// steady_clock is CLOCK_MONOTONIC on Linux, so GameClock::now() and the
+// deadlines slept on here are the same clock.
+
+#include <chrono>
+#include <cerrno>
+#include <ctime>
+
+using GameClock = std::chrono::steady_clock;
+
+constexpr int MAX_CATCH_UP_TICKS = 3;
+
+struct TickClock
+{
+    GameClock::duration period = std::chrono::milliseconds(150);
+    GameClock::time_point nextTick;
+    GameClock::time_point lastTick; // deadline of the tick being processed
+    GameClock::duration lastLate{0}; // how late the last wait woke up
+
+    // Jitter = how late we woke up after a deadline.
+    double jitterAvgUs = 0;     // exponential moving average
+    double jitterMaxUs = 0;
+    unsigned long ticks = 0;
+    unsigned long lateTicks = 0;    // waits that found more than one tick due
+    unsigned long skippedTicks = 0; // ticks dropped beyond MAX_CATCH_UP_TICKS
+
+    // Starts a fresh schedule with the first tick one period from now.
+    void resync(GameClock::duration newPeriod)
+    {
+        period = newPeriod;
+        lastTick = GameClock::now();
+        nextTick = lastTick + period;
+    }
+
+    static void sleepUntil(GameClock::time_point deadline)
+    {
+        auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(sinceEpoch.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(sinceEpoch.count() % 1000000000);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+        {
+        }
+    }
+
+    // Sleeps until the next deadline and returns how many ticks to simulate.
+    int wait()
+    {
+        if (GameClock::now() < nextTick)
+            sleepUntil(nextTick);
+        return advance();
+    }
+
+    // Books the tick(s) that are due now; for callers that did their own
+    // waiting until nextTick (e.g. in poll()). Returns how many to simulate.
+    int advance()
+    {
+        auto now = GameClock::now();
+        auto late = now - nextTick;
+        lastLate = late > GameClock::duration::zero() ? late : GameClock::duration::zero();
+        long behind = static_cast<long>(late / period); // whole periods missed beyond this one
+
+        double lateUs = std::chrono::duration<double, std::micro>(late).count();
+        jitterAvgUs += (lateUs - jitterAvgUs) / 16;
+        if (lateUs > jitterMaxUs)
+            jitterMaxUs = lateUs;
+
+        int due = 1;
+        if (behind > 0)
+        {
+            lateTicks++;
+            due = behind + 1 > MAX_CATCH_UP_TICKS ? MAX_CATCH_UP_TICKS : static_cast<int>(behind + 1);
+            skippedTicks += static_cast<unsigned long>(behind + 1 - due);
+        }
+
+        lastTick = nextTick + period * behind;
+        nextTick = lastTick + period;
+        ticks += static_cast<unsigned long>(due);
+        return due;
+    }
+};
@@ -0,0 +1,233 @@
+#pragma once
+
+// The game loop shared by the Unix, Windows and original builds, put
+// together at compile time.
+//
+// GameCore runs one tick the same way in all three: read the pending keys,
+// apply at most one queued turn, step the engine and redraw only the cells
+// the step changed. What a screen, a tick and a key are comes from three
+// policy types given as template arguments, so each build gets the loop
+// inlined for its platform with no virtual calls and no #ifdef inside it:
+//
+//   Terminal  void clear(const GameState &)   blank screen plus borders
+//             void cell(std::pair<int, int> pos, Cell what)
+//             void present(const GameState &) status line, flush the frame
+//   Clock     void start()                    a game (re)starts
+//             void wait()                     sleep until the next tick
+//   Input     void poll(F onKey)              onKey(char) for each pending key,
+//                                             stopping once it returns false
+//
+// A fourth, optional policy hooks into the tick itself. The Unix build
+// plugs its replays, autopilot and solver, recording and latency samples,
+// unbounded board and scrolling camera in here; the others use NullHooks:
+//
+//   Hooks     void beforeStep(Core &)         queue turns nobody typed
+//             void turned(Core &, time_point pressed)
+//                                             a queued turn was applied
+//             StepResult step(Core &)         move the snake one cell
+//             bool afterStep(Core &, const StepResult &)
+//                                             true if it drew the tick itself
+//
+// The null policies at the bottom draw nothing, never sleep and read no
+// keys, so the whole loop can run headless in tests and benchmarks.
+//
+// The engine ends the game when the snake runs into itself. The original
+// build used to let the snake pass through its own body; built on GameCore
+// it now dies there like the Unix and Windows builds always did.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "snake_engine.h"
+#include "snake_input.h"
+
+inline bool isTurnKey(char ch) { return ch == 'w' || ch == 'a' || ch == 's' || ch == 'd'; }
+
+inline Direction keyToDirection(char ch)
+{
+    switch (ch)
+    {
+    case 'w':
+        return Direction::UP;
+    case 's':
+        return Direction::DOWN;
+    case 'a':
+        return Direction::LEFT;
+    case 'd':
+    default:
+        return Direction::RIGHT;
+    }
+}
+
+// Adds nothing to the tick: no extra turns, and the snake moves on the
+// core's own board.
+struct NullHooks
+{
+    template <typename Core>
+    void beforeStep(Core &) {}
+
+    template <typename Core>
+    void turned(Core &, std::chrono::steady_clock::time_point) {}
+
+    template <typename Core>
+    StepResult step(Core &core) { return core.game.step(core.dir); }
+
+    template <typename Core>
+    bool afterStep(Core &, const StepResult &) { return false; }
+};
+
+template <typename Terminal, typename Clock, typename Input, typename Hooks = NullHooks>
+struct GameCore
+{
+    GameState game;
+    TurnQueue turns;
+    Direction dir = Direction::RIGHT;
+    bool running = true; // false once the snake dies or the player quits
+    uint64_t ticks = 0;
+
+    Terminal terminal;
+    Clock clock;
+    Input input;
+    Hooks hooks;
+
+    void reset(int width, int height, int food, uint64_t seed)
+    {
+        game.reset(width, height, food, seed);
+        turns.clear();
+        dir = Direction::RIGHT;
+        running = true;
+        ticks = 0;
+        redraw();
+        clock.start();
+    }
+
+    // Draws the whole board again, e.g. after a menu covered it.
+    void redraw()
+    {
+        terminal.clear(game);
+        for (size_t i = 0; i < game.length(); ++i)
+            terminal.cell(game.segment(i), Cell::SNAKE);
+        for (const auto &food : game.foodPositions)
+            terminal.cell(food, Cell::FOOD);
+        terminal.present(game);
+    }
+
+    // Handles w/a/s/d and q. Returns false for keys the game does not use.
+    // `readAt` is when the key was read, for latency samples; leave it
+    // empty for turns nobody typed.
+    bool key(char ch, std::chrono::steady_clock::time_point readAt = {})
+    {
+        if (isTurnKey(ch))
+            turns.push(dir, keyToDirection(ch), readAt);
+        else if (ch == 'q')
+            running = false;
+        else
+            return false;
+        return true;
+    }
+
+    // Reads the pending keys and plays one tick, drawing the cells it
+    // changed but not presenting them. Returns the first key read that the
+    // game does not use (0 if none), so the front end can open its menus.
+    // Keys after it stay unread until the menu or the next tick.
+    char update()
+    {
+        char command = 0;
+        input.poll([&](char ch)
+        {
+            if (key(ch))
+                return true;
+            command = ch;
+            return false;
+        });
+        if (!running)
+            return command;
+
+        hooks.beforeStep(*this);
+        std::chrono::steady_clock::time_point pressed;
+        if (turns.pop(dir, &pressed))
+            hooks.turned(*this, pressed);
+        StepResult result = hooks.step(*this);
+        ticks++;
+        bool drawn = hooks.afterStep(*this, result);
+        if (result.outcome == StepOutcome::DIED)
+        {
+            running = false;
+            return command;
+        }
+        if (drawn)
+            return command;
+
+        if (result.outcome == StepOutcome::ATE)
+        {
+            for (size_t i = result.firstNewFood; i < game.foodPositions.size(); ++i)
+                terminal.cell(game.foodPositions[i], Cell::FOOD);
+        }
+        else
+        {
+            terminal.cell(result.vacated, Cell::EMPTY);
+        }
+        terminal.cell(result.newHead, Cell::SNAKE);
+        return command;
+    }
+
+    // Plays one tick and presents it; see update().
+    char tick()
+    {
+        char command = update();
+        if (running)
+            terminal.present(game);
+        return command;
+    }
+
+    // Plays until the game ends or `maxTicks` ticks have passed, ignoring
+    // keys the game does not use. Returns the ticks played.
+    uint64_t run(uint64_t maxTicks = UINT64_MAX)
+    {
+        while (running && ticks < maxTicks)
+        {
+            tick();
+            clock.wait();
+        }
+        return ticks;
+    }
+};
+
+// Draws nothing; counts what it was asked to draw.
+struct NullTerminal
+{
+    unsigned long cells = 0, frames = 0;
+
+    void clear(const GameState &) {}
+    void cell(std::pair<int, int>, Cell) { cells++; }
+    void present(const GameState &) { frames++; }
+};
+
+// Ticks as fast as the loop runs.
+struct NullClock
+{
+    void start() {}
+    void wait() {}
+};
+
+struct NullInput
+{
+    template <typename F>
+    void poll(F &&) {}
+};
+
+// Plays back a fixed string of keys, one per tick.
+struct ScriptedInput
+{
+    std::string keys;
+    size_t next = 0;
+
+    template <typename F>
+    void poll(F &&onKey)
+    {
+        if (next < keys.size())
+            onKey(keys[next++]);
+    }
+};
@@ -0,0 +1,302 @@
+#pragma once
+
+// Headless game rules for the Unix build.
+//
+// Everything in here works on board-relative cells: row 0..height-1 and
+// column 0..width-1 of the play area, with no knowledge of the terminal.
+// The front end in snake_unix.cpp drives a GameState through step() and
+// draws whatever the returned StepResult says changed.
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+
+// Constants
+constexpr size_t MIN_RING_CAPACITY = 64;
+constexpr uint64_t MAX_BOARD_CELLS = UINT32_MAX; // cells are indexed with uint32_t
+
+enum class Direction{ UP, DOWN, LEFT, RIGHT };
+
+inline bool isReverse(Direction a, Direction b)
+{
+    return (a == Direction::UP && b == Direction::DOWN) || (a == Direction::DOWN && b == Direction::UP) ||
+           (a == Direction::LEFT && b == Direction::RIGHT) || (a == Direction::RIGHT && b == Direction::LEFT);
+}
+
+// What occupies a board cell. One byte per cell, row-major.
+enum class Cell : uint8_t { EMPTY, SNAKE, FOOD };
+
+// What GameState allocates per board cell: the grid, the free list and each cell's slot in it.
+constexpr uint64_t BOARD_BYTES_PER_CELL = sizeof(Cell) + 2 * sizeof(uint32_t);
+
+// Whether GameState can index every cell of a width x height board. Sides
+// stay below INT_MAX so the front end can add its border column.
+inline bool validBoardSize(uint64_t width, uint64_t height)
+{
+    return width >= 1 && height >= 1 && width < INT_MAX && height < INT_MAX && width * height <= MAX_BOARD_CELLS;
+}
+
+// xorshift64* generator. Each game owns one, so a seed fully determines
+// where food appears and games can run side by side without sharing rand().
+struct Rng
+{
+    uint64_t state = 1;
+
+    void seed(uint64_t value)
+    {
+        // splitmix64 scramble so nearby seeds give unrelated streams
+        uint64_t z = value + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1;
+    }
+
+    uint32_t next()
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+
+    // Uniform value in [0, n) without a division.
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>((static_cast<uint64_t>(next()) * n) >> 32); }
+};
+
+// Snake segments as packed cells, head first. Capacity is a power of two
+// and doubles when full, so push_front and pop_back are amortized O(1) and
+// the snake can grow to fill any board.
+template <typename T>
+struct BasicRing
+{
+    std::vector<T> buffer;
+    size_t head = 0, count = 0;
+
+    size_t size() const { return count; }
+    size_t capacity() const { return buffer.size(); }
+    void clear() { head = count = 0; }
+
+    T front() const { return buffer[head]; }
+    T back() const { return (*this)[count - 1]; }
+
+    // Segment i counted from the head (0 = head).
+    T operator[](size_t i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+
+    void push_front(T cell)
+    {
+        if (count == buffer.size())
+            grow();
+        head = (head - 1) & (buffer.size() - 1);
+        buffer[head] = cell;
+        count++;
+    }
+
+    T pop_back()
+    {
+        T cell = back();
+        count--;
+        return cell;
+    }
+
+    // Doubles the capacity and unwraps the segments so the head sits at index 0.
+    void grow()
+    {
+        std::vector<T> bigger(std::max(MIN_RING_CAPACITY, buffer.size() * 2));
+        for (size_t i = 0; i < count; ++i)
+            bigger[i] = (*this)[i];
+        buffer.swap(bigger);
+        head = 0;
+    }
+};
+
+// Cell indices (row * width + col) on a fixed-size board.
+using SnakeRing = BasicRing<uint32_t>;
+
+enum class StepOutcome{ MOVED, ATE, DIED };
+
+struct StepResult
+{
+    StepOutcome outcome = StepOutcome::MOVED;
+    std::pair<int, int> newHead = {0, 0};
+    std::pair<int, int> vacated = {0, 0}; // tail cell freed this tick, only valid for MOVED
+    size_t firstNewFood = 0;              // foodPositions[firstNewFood..] were spawned this tick
+};
+
+struct GameState
+{
+    int width = 0, height = 0;
+    int foodCount = 1;
+    unsigned int score = 0;
+    bool alive = true;
+    bool foodShortfall = false; // last spawn could not place every food item
+    Rng rng;
+
+    std::vector<std::pair<int, int>> foodPositions;
+
+    SnakeRing snake;
+
+    // Occupancy grid covering the play area, kept in sync with the snake and food.
+    std::vector<Cell> cells;
+
+    // Every EMPTY cell, in no particular order, plus where each cell sits in
+    // that list, so a cell can be added or swap-removed in O(1).
+    std::vector<uint32_t> freeCells;
+    std::vector<uint32_t> freeSlot;
+
+    uint32_t cellIndex(std::pair<int, int> pos) const { return static_cast<uint32_t>(pos.first) * width + pos.second; }
+    std::pair<int, int> cellPos(uint32_t index) const { return {static_cast<int>(index / width), static_cast<int>(index % width)}; }
+    Cell cellAt(int row, int col) const { return cells[cellIndex({row, col})]; }
+
+    void markFree(uint32_t index)
+    {
+        cells[index] = Cell::EMPTY;
+        freeSlot[index] = static_cast<uint32_t>(freeCells.size());
+        freeCells.push_back(index);
+    }
+
+    void markUsed(uint32_t index, Cell what)
+    {
+        if (cells[index] == Cell::EMPTY)
+        {
+            uint32_t slot = freeSlot[index];
+            uint32_t last = freeCells.back();
+            freeCells[slot] = last;
+            freeSlot[last] = slot;
+            freeCells.pop_back();
+        }
+        cells[index] = what;
+    }
+
+    void push_front(std::pair<int, int> pos)
+    {
+        uint32_t index = cellIndex(pos);
+        snake.push_front(index);
+        markUsed(index, Cell::SNAKE);
+    }
+
+    void pop_back()
+    {
+        markFree(snake.pop_back());
+    }
+
+    size_t length() const { return snake.size(); }
+    std::pair<int, int> get_front() const { return cellPos(snake.front()); }
+    std::pair<int, int> get_back() const { return cellPos(snake.back()); }
+
+    // Segment i counted from the head (0 = head).
+    std::pair<int, int> segment(size_t i) const { return cellPos(snake[i]); }
+
+    bool inBounds(int row, int col) const
+    {
+        return row >= 0 && row < height && col >= 0 && col < width;
+    }
+
+    // Starts a fresh game with a one-segment snake in the middle of the board.
+    void reset(int boardWidth, int boardHeight, int food, uint64_t seed)
+    {
+        rng.seed(seed);
+        width = boardWidth;
+        height = boardHeight;
+        foodCount = food;
+        score = 0;
+        alive = true;
+        foodShortfall = false;
+        foodPositions.clear();
+        snake.clear();
+
+        uint32_t area = static_cast<uint32_t>(width) * height;
+        cells.assign(area, Cell::EMPTY);
+        freeSlot.resize(area);
+        freeCells.resize(area);
+        for (uint32_t i = 0; i < area; ++i)
+            freeCells[i] = freeSlot[i] = i;
+
+        push_front({height / 2, width / 2});
+        spawnFood();
+    }
+
+    // Tops foodPositions back up to foodCount, each item on a uniformly
+    // random free cell. Returns false only if the board has no free cells left.
+    bool spawnFood()
+    {
+        int toSpawn = foodCount - static_cast<int>(foodPositions.size());
+
+        while (toSpawn > 0 && !freeCells.empty())
+        {
+            uint32_t index = freeCells[rng.below(static_cast<uint32_t>(freeCells.size()))];
+            markUsed(index, Cell::FOOD);
+            foodPositions.push_back(cellPos(index));
+            toSpawn--;
+        }
+
+        foodShortfall = toSpawn > 0;
+        return !foodShortfall;
+    }
+
+    // Advances the game by one tick with the snake heading in `action`.
+    StepResult step(Direction action)
+    {
+        StepResult result;
+        if (!alive)
+        {
+            result.outcome = StepOutcome::DIED;
+            return result;
+        }
+
+        int dx = 0, dy = 0;
+        switch (action)
+        {
+        case Direction::UP:
+            dx = -1;
+            break;
+        case Direction::DOWN:
+            dx = 1;
+            break;
+        case Direction::LEFT:
+            dy = -1;
+            break;
+        case Direction::RIGHT:
+            dy = 1;
+            break;
+        }
+
+        std::pair<int, int> currentHead = get_front();
+        std::pair<int, int> newHead = {currentHead.first + dx, currentHead.second + dy};
+        result.newHead = newHead;
+
+        if (!inBounds(newHead.first, newHead.second) ||
+            cells[cellIndex(newHead)] == Cell::SNAKE)
+        {
+            alive = false;
+            result.outcome = StepOutcome::DIED;
+            return result;
+        }
+
+        bool ate = false;
+        if (cells[cellIndex(newHead)] == Cell::FOOD)
+        {
+            score++;
+            ate = true;
+            foodPositions.erase(std::find(foodPositions.begin(), foodPositions.end(), newHead)); // Remove eaten food
+        }
+
+        push_front(newHead);
+
+        if (ate)
+        {
+            result.outcome = StepOutcome::ATE;
+            result.firstNewFood = foodPositions.size();
+            spawnFood();
+        }
+        else
+        {
+            result.outcome = StepOutcome::MOVED;
+            result.vacated = get_back();
+            pop_back();
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+// Streaming decoder for terminal keyboard input.
+//
+// Bytes are fed in whatever chunks read() returns and decoded by a small
+// VT state machine. Arrow keys arrive as CSI (ESC [ A) or SS3 (ESC O A)
+// sequences and come out as the matching w/a/s/d key; any other escape
+// sequence (including replies to terminal queries) is swallowed. A lone
+// ESC byte is only reported once ESC_TIMEOUT has passed with nothing
+// following it, which the caller waits for with poll() rather than a sleep.
+//
+// KeyQueue hands decoded keys from the input reader thread to the game
+// loop, and TurnQueue lines up the resulting direction changes so that
+// two quick presses inside one tick are both played, one per tick.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+#include "snake_engine.h"
+
+constexpr std::chrono::milliseconds ESC_TIMEOUT(25);
+constexpr size_t INPUT_QUEUE_SIZE = 64;
+constexpr size_t KEY_QUEUE_SIZE = 256;
+constexpr size_t MAX_QUEUED_TURNS = 4;
+
+struct InputDecoder
+{
+    enum class State{ GROUND, ESCAPE, CSI, SS3 };
+
+    State state = State::GROUND;
+    std::chrono::steady_clock::time_point escapeStart;
+
+    char keys[INPUT_QUEUE_SIZE];
+    size_t first = 0, count = 0;
+
+    void emit(char ch)
+    {
+        if (count == INPUT_QUEUE_SIZE)
+            return; // drop keys nobody is reading
+        keys[(first + count) % INPUT_QUEUE_SIZE] = ch;
+        count++;
+    }
+
+    // Next decoded key, or '\0' if none is ready.
+    char next()
+    {
+        if (count == 0)
+            return '\0';
+        char ch = keys[first];
+        first = (first + 1) % INPUT_QUEUE_SIZE;
+        count--;
+        return ch;
+    }
+
+    static char arrowKey(char final)
+    {
+        switch (final)
+        {
+        case 'A':
+            return 'w'; // Up
+        case 'B':
+            return 's'; // Down
+        case 'C':
+            return 'd'; // Right
+        case 'D':
+            return 'a'; // Left
+        }
+        return '\0';
+    }
+
+    void feed(const char *data, size_t n, std::chrono::steady_clock::time_point now)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            char ch = data[i];
+            switch (state)
+            {
+            case State::GROUND:
+                if (ch == '\033')
+                {
+                    state = State::ESCAPE;
+                    escapeStart = now;
+                }
+                else
+                {
+                    emit(ch);
+                }
+                break;
+
+            case State::ESCAPE:
+                if (ch == '[')
+                {
+                    state = State::CSI;
+                }
+                else if (ch == 'O')
+                {
+                    state = State::SS3;
+                }
+                else if (ch == '\033')
+                {
+                    emit('\033'); // ESC ESC: the first one was a bare ESC
+                    escapeStart = now;
+                }
+                else
+                {
+                    emit('\033');
+                    emit(ch);
+                    state = State::GROUND;
+                }
+                break;
+
+            case State::CSI:
+                // Parameter and intermediate bytes run until a final byte in 0x40..0x7E
+                if (ch >= 0x40 && ch <= 0x7E)
+                {
+                    char key = arrowKey(ch);
+                    if (key)
+                        emit(key);
+                    state = State::GROUND;
+                }
+                else if (ch < 0x20)
+                {
+                    state = State::GROUND; // malformed, drop it
+                }
+                break;
+
+            case State::SS3:
+                if (char key = arrowKey(ch))
+                    emit(key);
+                state = State::GROUND;
+                break;
+            }
+        }
+    }
+
+    // True while a lone ESC is waiting to find out whether a sequence follows.
+    bool escapePending() const { return state == State::ESCAPE; }
+
+    std::chrono::steady_clock::time_point escapeDeadline() const { return escapeStart + ESC_TIMEOUT; }
+
+    // Reports a pending ESC as a key press once its timeout has passed.
+    void expire(std::chrono::steady_clock::time_point now)
+    {
+        if (state == State::ESCAPE && now >= escapeDeadline())
+        {
+            emit('\033');
+            state = State::GROUND;
+        }
+    }
+};
+
+struct KeyEvent
+{
+    char key = '\0';
+    std::chrono::steady_clock::time_point readAt; // when read() returned its bytes
+};
+
+// Lock-free single-producer/single-consumer ring of key presses.
+struct KeyQueue
+{
+    KeyEvent keys[KEY_QUEUE_SIZE];
+    std::atomic<size_t> head{0}; // next slot to pop, owned by the consumer
+    std::atomic<size_t> tail{0}; // next slot to push, owned by the producer
+
+    bool push(const KeyEvent &event)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == KEY_QUEUE_SIZE)
+            return false;
+        keys[t % KEY_QUEUE_SIZE] = event;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Next key, or an event with key '\0' if the queue is empty.
+    KeyEvent pop()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return KeyEvent();
+        KeyEvent event = keys[h % KEY_QUEUE_SIZE];
+        head.store(h + 1, std::memory_order_release);
+        return event;
+    }
+};
+
+// Pending direction changes, applied one per tick in the order pressed.
+// A turn is checked against the last queued direction, not the one the
+// snake is moving in now, so up-then-left from RIGHT queues both turns.
+struct TurnQueue
+{
+    Direction turns[MAX_QUEUED_TURNS];
+    std::chrono::steady_clock::time_point readAt[MAX_QUEUED_TURNS];
+    size_t first = 0, count = 0;
+
+    void clear() { first = count = 0; }
+
+    // Queues `to` unless it repeats or reverses the direction the snake
+    // will be heading in by then. Returns whether it was queued. `pressed`
+    // is left empty for turns nobody typed (bots, replays).
+    bool push(Direction current, Direction to, std::chrono::steady_clock::time_point pressed = {})
+    {
+        Direction last = count ? turns[(first + count - 1) % MAX_QUEUED_TURNS] : current;
+        if (to == last || isReverse(last, to) || count == MAX_QUEUED_TURNS)
+            return false;
+        turns[(first + count) % MAX_QUEUED_TURNS] = to;
+        readAt[(first + count) % MAX_QUEUED_TURNS] = pressed;
+        count++;
+        return true;
+    }
+
+    bool pop(Direction &out, std::chrono::steady_clock::time_point *pressed = nullptr)
+    {
+        if (count == 0)
+            return false;
+        out = turns[first];
+        if (pressed)
+            *pressed = readAt[first];
+        first = (first + 1) % MAX_QUEUED_TURNS;
+        count--;
+        return true;
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+// Keypress-to-photon latency tracking.
+//
+// Every direction key carries the time its bytes came back from read().
+// When updateSnake applies the turn the tick time is noted, and once the
+// frame showing it has been written the three spans are recorded:
+//   read -> tick   time spent queued and waiting for the next tick
+//   tick -> write  simulation, rendering and the write() itself
+//   read -> write  the whole path
+// Samples go into log-bucketed histograms per speed level (0 = the default
+// speed, 1-4 = the levels offered by changeSnakeSpeed). When disabled the
+// game loop only pays for a bool check.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+constexpr int LATENCY_SPEED_LEVELS = 5;
+constexpr int HISTOGRAM_SUB_BUCKETS = 16; // per power of two, ~6% resolution
+constexpr int HISTOGRAM_BUCKETS = 64 * HISTOGRAM_SUB_BUCKETS;
+
+struct LatencyHistogram
+{
+    uint64_t counts[HISTOGRAM_BUCKETS] = {};
+    uint64_t samples = 0;
+    uint64_t maxUs = 0;
+
+    static int bucketOf(uint64_t us)
+    {
+        if (us < HISTOGRAM_SUB_BUCKETS)
+            return static_cast<int>(us);
+        int exponent = 63 - __builtin_clzll(us); // >= 4
+        int sub = static_cast<int>((us >> (exponent - 4)) & (HISTOGRAM_SUB_BUCKETS - 1));
+        return (exponent - 3) * HISTOGRAM_SUB_BUCKETS + sub;
+    }
+
+    // Smallest value that falls into `bucket`.
+    static uint64_t bucketFloor(int bucket)
+    {
+        if (bucket < HISTOGRAM_SUB_BUCKETS)
+            return static_cast<uint64_t>(bucket);
+        int exponent = bucket / HISTOGRAM_SUB_BUCKETS + 3;
+        uint64_t sub = static_cast<uint64_t>(bucket % HISTOGRAM_SUB_BUCKETS);
+        return (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 4);
+    }
+
+    void record(uint64_t us)
+    {
+        counts[bucketOf(us)]++;
+        samples++;
+        if (us > maxUs)
+            maxUs = us;
+    }
+
+    uint64_t percentile(double p) const
+    {
+        if (samples == 0)
+            return 0;
+        uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(samples - 1)) + 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; ++b)
+        {
+            seen += counts[b];
+            if (seen >= rank)
+                return bucketFloor(b);
+        }
+        return maxUs;
+    }
+};
+
+struct LatencyTracker
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Level
+    {
+        LatencyHistogram readToTick, tickToWrite, readToWrite;
+    };
+
+    struct Applied
+    {
+        Clock::time_point readAt, tickAt;
+    };
+
+    bool enabled = false;
+    Level levels[LATENCY_SPEED_LEVELS];
+    std::vector<Applied> pending; // turns applied but not yet on screen
+
+    static uint64_t micros(Clock::duration d)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        return us > 0 ? static_cast<uint64_t>(us) : 0;
+    }
+
+    void applied(Clock::time_point readAt, Clock::time_point tickAt)
+    {
+        pending.push_back({readAt, tickAt});
+    }
+
+    void written(Clock::time_point writeAt, int speedLevel)
+    {
+        Level &level = levels[speedLevel];
+        for (const Applied &turn : pending)
+        {
+            level.readToTick.record(micros(turn.tickAt - turn.readAt));
+            level.tickToWrite.record(micros(writeAt - turn.tickAt));
+            level.readToWrite.record(micros(writeAt - turn.readAt));
+        }
+        pending.clear();
+    }
+
+    static void printRow(FILE *out, const char *name, const LatencyHistogram &h)
+    {
+        fprintf(out, "  %-14s %8llu %10llu %10llu %10llu\n", name,
+                static_cast<unsigned long long>(h.samples),
+                static_cast<unsigned long long>(h.percentile(0.50)),
+                static_cast<unsigned long long>(h.percentile(0.99)),
+                static_cast<unsigned long long>(h.maxUs));
+    }
+
+    void report(FILE *out) const
+    {
+        fprintf(out, "Input latency (microseconds)\n");
+        for (int i = 0; i < LATENCY_SPEED_LEVELS; ++i)
+        {
+            const Level &level = levels[i];
+            if (level.readToWrite.samples == 0)
+                continue;
+            if (i == 0)
+                fprintf(out, "Default speed\n");
+            else
+                fprintf(out, "Speed level %d\n", i);
+            fprintf(out, "  %-14s %8s %10s %10s %10s\n", "span", "samples", "p50", "p99", "max");
+            printRow(out, "read -> tick", level.readToTick);
+            printRow(out, "tick -> write", level.tickToWrite);
+            printRow(out, "read -> write", level.readToWrite);
+        }
+    }
+};
@@ -0,0 +1,239 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "snake_engine.h"
+#include "snake_latency.h"
+#include "snake_net.h"
+
+using namespace std;
+
+// Load generator for snake_server: opens many client connections, steers
+// each snake at random and measures tick-to-receive latency, the time from
+// the server finishing a tick to the client having read its delta.
+// Build: g++ -O2 snake_loadgen.cpp -o snake_loadgen
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t READ_CHUNK = 64 * 1024;
+
+struct LoadOptions
+{
+    string socketPath = "/tmp/snake.sock";
+    int clients = 200;
+    int seconds = 10;
+    uint32_t turnPercent = 10; // chance per tick that a client sends a turn
+    uint64_t seed = 1;
+};
+
+struct LoadClient
+{
+    int fd = -1;
+    vector<uint8_t> in;
+    uint64_t ticks = 0;
+    uint64_t lastTick = 0;
+    uint64_t gaps = 0; // tick numbers skipped
+    bool welcomed = false;
+};
+
+struct LoadStats
+{
+    LatencyHistogram latency;
+    uint64_t messages = 0, bytes = 0, changes = 0, turnsSent = 0, disconnects = 0, gaps = 0;
+};
+
+int connectClient(const string &path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Handles every complete message in the client's buffer. Returns false on
+// a malformed stream.
+bool consume(LoadClient &client, LoadStats &stats, Rng &rng, const LoadOptions &options, vector<CellChange> &changes)
+{
+    static const char turnKeys[] = {'w', 'a', 's', 'd'};
+    size_t pos = 0;
+    char type;
+    const uint8_t *payload;
+    size_t length;
+    while (size_t used = nextMessage(client.in.data() + pos, client.in.size() - pos, type, payload, length))
+    {
+        pos += used;
+        stats.messages++;
+        MessageReader reader(payload, length);
+        uint64_t sentNs, tick;
+
+        if (type == MSG_WELCOME)
+        {
+            client.welcomed = true;
+        }
+        else if (type == MSG_KEYFRAME)
+        {
+            if (!reader.varint(tick) || !reader.changes(changes))
+                return false;
+            client.lastTick = tick;
+        }
+        else if (type == MSG_TICK)
+        {
+            if (!reader.u64(sentNs) || !reader.varint(tick) || !reader.changes(changes))
+                return false;
+            uint64_t nowNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now().time_since_epoch()).count());
+            stats.latency.record(nowNs > sentNs ? (nowNs - sentNs) / 1000 : 0);
+            stats.changes += changes.size();
+            if (client.lastTick && tick > client.lastTick + 1)
+                client.gaps += tick - client.lastTick - 1;
+            client.lastTick = tick;
+            client.ticks++;
+
+            if (rng.below(100) < options.turnPercent)
+            {
+                char key = turnKeys[rng.below(4)];
+                if (write(client.fd, &key, 1) == 1)
+                    stats.turnsSent++;
+            }
+        }
+    }
+    client.in.erase(client.in.begin(), client.in.begin() + static_cast<ptrdiff_t>(pos));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (arg == "--clients" && hasValue)
+            options.clients = atoi(argv[++i]);
+        else if (arg == "--seconds" && hasValue)
+            options.seconds = atoi(argv[++i]);
+        else if (arg == "--turn-percent" && hasValue)
+            options.turnPercent = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--seed" && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "usage: %s [--socket PATH] [--clients N] [--seconds S] [--turn-percent P] [--seed S]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    vector<LoadClient> clients(static_cast<size_t>(max(0, options.clients)));
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        clients[i].fd = connectClient(options.socketPath);
+        if (clients[i].fd < 0)
+        {
+            fprintf(stderr, "connect %s: %s (after %zu clients)\n", options.socketPath.c_str(), strerror(errno), i);
+            return 1;
+        }
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, clients[i].fd, &event);
+    }
+
+    LoadStats stats;
+    Rng rng;
+    rng.seed(options.seed);
+    vector<CellChange> changes;
+    vector<uint8_t> chunk(READ_CHUNK);
+    epoll_event events[MAX_EVENTS];
+
+    auto start = chrono::steady_clock::now();
+    auto end = start + chrono::seconds(options.seconds);
+    while (true)
+    {
+        auto now = chrono::steady_clock::now();
+        if (now >= end)
+            break;
+        int timeoutMs = static_cast<int>(chrono::duration_cast<chrono::milliseconds>(end - now).count()) + 1;
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        for (int e = 0; e < n; ++e)
+        {
+            LoadClient &client = clients[events[e].data.u64];
+            if (client.fd < 0)
+                continue;
+
+            bool closed = false;
+            while (true)
+            {
+                ssize_t got = read(client.fd, chunk.data(), chunk.size());
+                if (got > 0)
+                {
+                    stats.bytes += static_cast<uint64_t>(got);
+                    client.in.insert(client.in.end(), chunk.begin(), chunk.begin() + got);
+                    continue;
+                }
+                if (got < 0 && errno == EINTR)
+                    continue;
+                closed = got == 0 || errno != EAGAIN;
+                break;
+            }
+
+            if (!consume(client, stats, rng, options, changes) || closed)
+            {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, client.fd, nullptr);
+                close(client.fd);
+                client.fd = -1;
+                stats.disconnects++;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint64_t ticks = 0, minTicks = UINT64_MAX;
+    for (const LoadClient &client : clients)
+    {
+        ticks += client.ticks;
+        minTicks = min(minTicks, client.ticks);
+        stats.gaps += client.gaps;
+        if (client.fd >= 0)
+            close(client.fd);
+    }
+    if (clients.empty())
+        minTicks = 0;
+
+    printf("%d clients for %.1f s: %llu tick messages (%.1f/s per client, slowest client %llu), %llu disconnected\n",
+           options.clients, seconds, static_cast<unsigned long long>(ticks),
+           clients.empty() ? 0.0 : ticks / seconds / static_cast<double>(clients.size()),
+           static_cast<unsigned long long>(minTicks), static_cast<unsigned long long>(stats.disconnects));
+    printf("  received %.2f MB (%.2f MB/s), %.1f changes per tick message, %llu turns sent, %llu ticks missed\n",
+           stats.bytes / 1e6, stats.bytes / seconds / 1e6, ticks ? static_cast<double>(stats.changes) / ticks : 0.0,
+           static_cast<unsigned long long>(stats.turnsSent), static_cast<unsigned long long>(stats.gaps));
+    printf("  tick-to-receive latency (us): p50 %llu  p99 %llu  p99.9 %llu  max %llu\n",
+           static_cast<unsigned long long>(stats.latency.percentile(0.50)),
+           static_cast<unsigned long long>(stats.latency.percentile(0.99)),
+           static_cast<unsigned long long>(stats.latency.percentile(0.999)),
+           static_cast<unsigned long long>(stats.latency.maxUs));
+    return 0;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+// Wire format shared by snake_server and its clients.
+//
+// The server talks over a Unix domain stream socket. Everything it sends
+// is a framed message:
+//
+//   type:u8 length:u32le payload[length]
+//
+//   'W' welcome   playerId width height tickUs             (varints)
+//   'K' keyframe  tick count { cell value }                (varints)
+//   'T' tick      sentNs:u64le tick count { cell value }   (varints)
+//
+// A keyframe lists every non-empty cell of the board; a tick message lists
+// only the cells that changed during that tick, in the order they changed.
+// sentNs is the server's steady_clock time when the tick finished, so a
+// client on the same machine can measure tick-to-receive latency. Cell
+// values are CELL_EMPTY, CELL_FOOD or CELL_SNAKE + player id.
+//
+// Clients send single bytes with the same meaning as in handleInput():
+// 'w', 'a', 's', 'd' to turn and 'q' to leave.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr char MSG_WELCOME = 'W';
+constexpr char MSG_KEYFRAME = 'K';
+constexpr char MSG_TICK = 'T';
+constexpr size_t MSG_HEADER_SIZE = 5;
+
+constexpr uint16_t CELL_EMPTY = 0;
+constexpr uint16_t CELL_FOOD = 1;
+constexpr uint16_t CELL_SNAKE = 2; // + player id
+
+struct CellChange
+{
+    uint32_t cell;
+    uint16_t value;
+};
+
+struct MessageWriter
+{
+    std::vector<uint8_t> &out;
+    size_t start;
+
+    // Appends a header whose length is filled in by finish().
+    MessageWriter(std::vector<uint8_t> &buffer, char type) : out(buffer), start(buffer.size())
+    {
+        out.push_back(static_cast<uint8_t>(type));
+        out.resize(out.size() + 4);
+    }
+
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void u64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void changes(const CellChange *first, size_t count)
+    {
+        varint(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            varint(first[i].cell);
+            varint(first[i].value);
+        }
+    }
+
+    void finish()
+    {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - MSG_HEADER_SIZE);
+        for (int i = 0; i < 4; ++i)
+            out[start + 1 + static_cast<size_t>(i)] = static_cast<uint8_t>(length >> (8 * i));
+    }
+};
+
+struct MessageReader
+{
+    const uint8_t *data;
+    size_t size, pos = 0;
+
+    MessageReader(const uint8_t *payload, size_t length) : data(payload), size(length) {}
+
+    bool varint(uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < size; shift += 7)
+        {
+            uint8_t byte = data[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    bool u64(uint64_t &value)
+    {
+        if (size - pos < 8)
+            return false;
+        value = 0;
+        for (int i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(data[pos++]) << (8 * i);
+        return true;
+    }
+
+    // Reads a change list; `out` is reused between calls.
+    bool changes(std::vector<CellChange> &out)
+    {
+        uint64_t count, cell, value;
+        if (!varint(count))
+            return false;
+        out.clear();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (!varint(cell) || !varint(value))
+                return false;
+            out.push_back({static_cast<uint32_t>(cell), static_cast<uint16_t>(value)});
+        }
+        return true;
+    }
+};
+
+// Splits a byte stream into messages. Returns the size of the complete
+// message at the start of `data` (header included), or 0 if more bytes
+// are needed.
+inline size_t nextMessage(const uint8_t *data, size_t size, char &type, const uint8_t *&payload, size_t &length)
+{
+    if (size < MSG_HEADER_SIZE)
+        return 0;
+    length = static_cast<size_t>(data[1]) | static_cast<size_t>(data[2]) << 8 |
+             static_cast<size_t>(data[3]) << 16 | static_cast<size_t>(data[4]) << 24;
+    if (size - MSG_HEADER_SIZE < length)
+        return 0;
+    type = static_cast<char>(data[0]);
+    payload = data + MSG_HEADER_SIZE;
+    return MSG_HEADER_SIZE + length;
+}
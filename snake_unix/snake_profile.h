@@ -0,0 +1,89 @@
+#pragma once
+
+// Per-frame profiling counters for the game loop.
+//
+// gameLoop() times each phase of a frame and hands the sample to
+// FrameProfiler::record(). Running totals are relaxed atomics so another
+// thread can read them without locking; the rolling averages shown in the
+// sidebar panel are exponential moving averages over roughly the last 16
+// frames. With a CSV path set, every sample is also kept and written out
+// by dumpCsv() at exit.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct FrameSample
+{
+    uint64_t simNs = 0;    // input handling and engine ticks
+    uint64_t renderNs = 0; // sidebar, framebuffer diff and write()
+    uint64_t bytes = 0;    // bytes written to the terminal
+    uint64_t writes = 0;   // write() syscalls
+    uint64_t sleepNs = 0;  // time waiting for the next tick
+    uint64_t lateNs = 0;   // how far past its deadline the next tick started
+};
+
+struct FrameProfiler
+{
+    bool showPanel = false;
+    std::string csvPath;
+
+    std::atomic<uint64_t> frames{0}, simNs{0}, renderNs{0}, bytes{0}, writes{0}, sleepNs{0}, lateNs{0};
+
+    // Rolling averages, only touched by the game loop.
+    double avgSimNs = 0, avgRenderNs = 0, avgBytes = 0, avgWrites = 0, avgSleepNs = 0, avgLateNs = 0;
+
+    std::vector<FrameSample> history;
+
+    static void add(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static void smooth(double &avg, uint64_t value)
+    {
+        avg += (static_cast<double>(value) - avg) / 16;
+    }
+
+    void record(const FrameSample &sample)
+    {
+        add(frames, 1);
+        add(simNs, sample.simNs);
+        add(renderNs, sample.renderNs);
+        add(bytes, sample.bytes);
+        add(writes, sample.writes);
+        add(sleepNs, sample.sleepNs);
+        add(lateNs, sample.lateNs);
+
+        smooth(avgSimNs, sample.simNs);
+        smooth(avgRenderNs, sample.renderNs);
+        smooth(avgBytes, sample.bytes);
+        smooth(avgWrites, sample.writes);
+        smooth(avgSleepNs, sample.sleepNs);
+        smooth(avgLateNs, sample.lateNs);
+
+        if (!csvPath.empty())
+            history.push_back(sample);
+    }
+
+    bool dumpCsv() const
+    {
+        FILE *out = fopen(csvPath.c_str(), "w");
+        if (!out)
+            return false;
+
+        fprintf(out, "frame,sim_ns,render_ns,bytes,writes,sleep_ns,late_ns\n");
+        for (size_t i = 0; i < history.size(); ++i)
+        {
+            const FrameSample &s = history[i];
+            fprintf(out, "%zu,%llu,%llu,%llu,%llu,%llu,%llu\n", i,
+                    static_cast<unsigned long long>(s.simNs), static_cast<unsigned long long>(s.renderNs),
+                    static_cast<unsigned long long>(s.bytes), static_cast<unsigned long long>(s.writes),
+                    static_cast<unsigned long long>(s.sleepNs), static_cast<unsigned long long>(s.lateNs));
+        }
+        fclose(out);
+        return true;
+    }
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+// Double-buffered terminal framebuffer.
+//
+// The game draws into the back buffer with put()/text(), then present()
+// compares it with the front buffer (what the terminal is showing) and
+// appends escape sequences for the changed cells only. Nearby changes on
+// the same row are merged into one run so they share a single cursor move.
+// The colour the terminal is drawing with (the pen) is tracked across the
+// runs of a frame, so a colour is sent when it changes, not once per run.
+//
+// FrameOutput collects those bytes for a whole tick and sends them with a
+// single write(), so the terminal never sees half a frame.
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+
+// Unchanged cells bridged inside a run before a new cursor move is cheaper.
+constexpr int RUN_GAP = 4;
+
+// Foreground colour SGR sequences for each colour depth, for
+// FrameBuffer::styles: the basic 30-37/90-97 codes, the 256-colour
+// palette and 24-bit truecolor.
+inline std::string sgrColor(int code) { return "\033[" + std::to_string(code) + "m"; }
+inline std::string sgrColor256(int index) { return "\033[38;5;" + std::to_string(index) + "m"; }
+inline std::string sgrTrueColor(int r, int g, int b)
+{
+    return "\033[38;2;" + std::to_string(r) + ";" + std::to_string(g) + ";" + std::to_string(b) + "m";
+}
+
+struct ScreenCell
+{
+    char ch = ' ';
+    uint8_t style = 0; // index into FrameBuffer::styles, 0 = terminal default
+
+    bool operator==(const ScreenCell &other) const { return ch == other.ch && style == other.style; }
+    bool operator!=(const ScreenCell &other) const { return !(*this == other); }
+};
+
+struct FrameBuffer
+{
+    int rows = 0, cols = 0;
+    std::vector<ScreenCell> front, back;
+    // SGR sequence per style id. Each sets only the foreground colour, so
+    // one can follow another without a reset and a blank cell looks the
+    // same in any of them.
+    std::vector<std::string> styles = {""};
+
+    // Resizes both buffers and assumes the terminal has just been cleared.
+    void resize(int newRows, int newCols)
+    {
+        rows = newRows > 0 ? newRows : 0;
+        cols = newCols > 0 ? newCols : 0;
+        front.assign(static_cast<size_t>(rows) * cols, ScreenCell());
+        back.assign(static_cast<size_t>(rows) * cols, ScreenCell());
+    }
+
+    // Resizes both buffers for a terminal that was resized without being
+    // cleared. Cells the terminal still shows stay in the front buffer;
+    // newly exposed ones may hold anything, so they are marked unknown and
+    // the next present() sends them even if they are to stay blank. The
+    // back buffer starts empty, ready for a full redraw that costs only
+    // the cells that actually changed.
+    void reshape(int newRows, int newCols)
+    {
+        newRows = newRows > 0 ? newRows : 0;
+        newCols = newCols > 0 ? newCols : 0;
+        const ScreenCell unknown = {'\0', 0};
+        std::vector<ScreenCell> kept(static_cast<size_t>(newRows) * newCols, unknown);
+        for (int row = 0; row < std::min(rows, newRows); ++row)
+        {
+            for (int col = 0; col < std::min(cols, newCols); ++col)
+                kept[static_cast<size_t>(row) * newCols + col] = front[static_cast<size_t>(row) * cols + col];
+        }
+        rows = newRows;
+        cols = newCols;
+        front.swap(kept);
+        back.assign(front.size(), ScreenCell());
+    }
+
+    // Forgets what is on screen, e.g. after clearTerminal() or a menu drew over it.
+    // The next present() repaints every non-blank cell of the back buffer.
+    void invalidate() { front.assign(front.size(), ScreenCell()); }
+
+    // Row and column are 1-based terminal coordinates, like moveCursorTo().
+    void put(int row, int col, char ch, uint8_t style = 0)
+    {
+        if (row < 1 || row > rows || col < 1 || col > cols)
+            return;
+        back[static_cast<size_t>(row - 1) * cols + (col - 1)] = {ch, style};
+    }
+
+    void text(int row, int col, const std::string &str, uint8_t style = 0)
+    {
+        for (size_t i = 0; i < str.size(); ++i)
+            put(row, col + static_cast<int>(i), str[i], style);
+    }
+
+    // Appends the bytes that turn the front buffer into the back buffer.
+    void present(std::string &out)
+    {
+        uint8_t pen = 0;
+        for (int row = 0; row < rows; ++row)
+        {
+            const size_t rowStart = static_cast<size_t>(row) * cols;
+            int col = 0;
+            while (col < cols)
+            {
+                if (back[rowStart + col] == front[rowStart + col])
+                {
+                    col++;
+                    continue;
+                }
+
+                int last = col;
+                for (int next = col + 1; next < cols && next - last <= RUN_GAP; ++next)
+                {
+                    if (back[rowStart + next] != front[rowStart + next])
+                        last = next;
+                }
+
+                appendRun(out, &back[rowStart], row, col, last, pen);
+                for (int c = col; c <= last; ++c)
+                    front[rowStart + c] = back[rowStart + c];
+                col = last + 1;
+            }
+        }
+        resetPen(out, pen);
+    }
+
+    // Appends a full repaint of what is on screen (the front buffer) for a
+    // terminal in an unknown state. Leaves the diff state alone.
+    void repaint(std::string &out) const
+    {
+        out += "\033[0m\033[H\033[J";
+        const ScreenCell blank;
+        uint8_t pen = 0;
+        for (int row = 0; row < rows; ++row)
+        {
+            const size_t rowStart = static_cast<size_t>(row) * cols;
+            int col = 0;
+            while (col < cols)
+            {
+                if (front[rowStart + col] == blank)
+                {
+                    col++;
+                    continue;
+                }
+
+                int last = col;
+                for (int next = col + 1; next < cols && next - last <= RUN_GAP; ++next)
+                {
+                    if (front[rowStart + next] != blank)
+                        last = next;
+                }
+                appendRun(out, &front[rowStart], row, col, last, pen);
+                col = last + 1;
+            }
+        }
+        resetPen(out, pen);
+    }
+
+    // Cursor move plus cells col..last of a row. `pen` is the style the
+    // terminal is drawing with and is only switched for a visible cell
+    // that needs another one; runs leave it set for the next run.
+    void appendRun(std::string &out, const ScreenCell *line, int row, int col, int last, uint8_t &pen) const
+    {
+        appendCursorMove(out, row + 1, col + 1);
+        for (int c = col; c <= last; ++c)
+        {
+            const ScreenCell &cell = line[c];
+            if (cell.style != pen && cell.ch != ' ')
+            {
+                out += cell.style == 0 ? "\033[0m" : styles[cell.style];
+                pen = cell.style;
+            }
+            out += cell.ch;
+        }
+    }
+
+    // Leaves the terminal in its default colours for whatever is written
+    // outside the framebuffer, e.g. the menus.
+    static void resetPen(std::string &out, uint8_t &pen)
+    {
+        if (pen != 0)
+            out += "\033[0m";
+        pen = 0;
+    }
+
+    static void appendCursorMove(std::string &out, int row, int col)
+    {
+        char seq[32];
+        int n = snprintf(seq, sizeof(seq), "\033[%d;%dH", row, col);
+        out.append(seq, static_cast<size_t>(n));
+    }
+};
+
+// One contiguous, reused buffer per frame, flushed with one write() call.
+struct FrameOutput
+{
+    std::string bytes;
+    bool synchronized = false; // wrap frames in DEC mode 2026 (synchronized output)
+
+    // Totals since start-up, for profiling.
+    unsigned long frames = 0, writeCalls = 0, bytesWritten = 0;
+
+    size_t prefixSize = 0;
+
+    void begin()
+    {
+        bytes.clear();
+        if (synchronized)
+            bytes += "\033[?2026h";
+        prefixSize = bytes.size();
+    }
+
+    // Writes the frame to `fd`. Retries short writes, EINTR and EAGAIN
+    // (stdout shares the tty with the non-blocking stdin).
+    void flush(int fd)
+    {
+        frames++;
+        if (bytes.size() == prefixSize)
+            return; // nothing changed this frame
+
+        if (synchronized)
+            bytes += "\033[?2026l";
+
+        size_t done = 0;
+        while (done < bytes.size())
+        {
+            ssize_t n = write(fd, bytes.data() + done, bytes.size() - done);
+            writeCalls++;
+            if (n > 0)
+            {
+                done += static_cast<size_t>(n);
+            }
+            else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+            }
+            else if (n < 0 && errno != EINTR)
+            {
+                break;
+            }
+        }
+        bytesWritten += done;
+    }
+};
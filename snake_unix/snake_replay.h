@@ -0,0 +1,226 @@
+#pragma once
+
+// Compact binary game recordings.
+//
+// A replay holds everything needed to re-run a game exactly: the engine
+// seed, board size, food count and speed, followed by the inputs that
+// reached the turn queue, each tagged with the tick before which it was
+// handled. Layout:
+//
+//   "SNKR" version:u8
+//   seed width height foodCount speedUs          (varints)
+//   { tickDelta:varint code:u8 [value:varint] }  (events)
+//   tickDelta:varint 'E' score:varint            (end marker, total ticks)
+//
+// Codes are the turn keys 'w', 'a', 's', 'd' plus 'F' (food count changed
+// to value) and 'V' (speed changed to value microseconds). decode() rejects
+// a file whose header or values the engine cannot run, an unknown code, or
+// bytes missing from or trailing the end marker.
+
+#include <cstdint>
+#include <climits>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "snake_engine.h"
+#include "snake_input.h"
+
+constexpr uint8_t REPLAY_VERSION = 1;
+
+struct ReplayEvent
+{
+    uint64_t tick = 0;
+    char code = '\0';
+    uint64_t value = 0;
+};
+
+struct Replay
+{
+    uint64_t seed = 0;
+    int width = 0, height = 0;
+    int foodCount = 1;
+    int speedUs = 0;
+    std::vector<ReplayEvent> events;
+    uint64_t ticks = 0;      // engine steps in the recorded game
+    unsigned int score = 0;  // final score, to check playback against
+
+    static bool hasValue(char code) { return code == 'F' || code == 'V'; }
+    static bool knownCode(char code) { return code == 'w' || code == 'a' || code == 's' || code == 'd' || hasValue(code); }
+
+    // Food counts and speeds are ints in the game and must be positive.
+    static bool validSetting(uint64_t value) { return value >= 1 && value <= INT_MAX; }
+
+    static void putVarint(std::vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static bool getVarint(const std::vector<uint8_t> &in, size_t &pos, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+        {
+            uint8_t byte = in[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> encode() const
+    {
+        std::vector<uint8_t> out = {'S', 'N', 'K', 'R', REPLAY_VERSION};
+        putVarint(out, seed);
+        putVarint(out, static_cast<uint64_t>(width));
+        putVarint(out, static_cast<uint64_t>(height));
+        putVarint(out, static_cast<uint64_t>(foodCount));
+        putVarint(out, static_cast<uint64_t>(speedUs));
+
+        uint64_t lastTick = 0;
+        for (const ReplayEvent &event : events)
+        {
+            putVarint(out, event.tick - lastTick);
+            out.push_back(static_cast<uint8_t>(event.code));
+            if (hasValue(event.code))
+                putVarint(out, event.value);
+            lastTick = event.tick;
+        }
+
+        putVarint(out, ticks - lastTick);
+        out.push_back('E');
+        putVarint(out, score);
+        return out;
+    }
+
+    bool decode(const std::vector<uint8_t> &in)
+    {
+        if (in.size() < 5 || in[0] != 'S' || in[1] != 'N' || in[2] != 'K' || in[3] != 'R' || in[4] != REPLAY_VERSION)
+            return false;
+
+        size_t pos = 5;
+        uint64_t w, h, food, speed;
+        if (!getVarint(in, pos, seed) || !getVarint(in, pos, w) || !getVarint(in, pos, h) ||
+            !getVarint(in, pos, food) || !getVarint(in, pos, speed))
+            return false;
+        if (!validBoardSize(w, h) || !validSetting(food) || !validSetting(speed))
+            return false;
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        foodCount = static_cast<int>(food);
+        speedUs = static_cast<int>(speed);
+
+        events.clear();
+        uint64_t tick = 0;
+        while (pos < in.size())
+        {
+            uint64_t delta;
+            if (!getVarint(in, pos, delta) || pos >= in.size())
+                return false;
+            tick += delta;
+            char code = static_cast<char>(in[pos++]);
+
+            if (code == 'E')
+            {
+                uint64_t finalScore;
+                if (!getVarint(in, pos, finalScore) || pos != in.size() || finalScore > UINT_MAX)
+                    return false;
+                ticks = tick;
+                score = static_cast<unsigned int>(finalScore);
+                return true;
+            }
+
+            ReplayEvent event;
+            event.tick = tick;
+            event.code = code;
+            if (!knownCode(code))
+                return false;
+            if (hasValue(code) && (!getVarint(in, pos, event.value) || !validSetting(event.value)))
+                return false;
+            events.push_back(event);
+        }
+        return false; // no end marker
+    }
+
+    bool save(const std::string &path) const
+    {
+        std::vector<uint8_t> bytes = encode();
+        FILE *out = fopen(path.c_str(), "wb");
+        if (!out)
+            return false;
+        bool ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+        return fclose(out) == 0 && ok;
+    }
+
+    bool load(const std::string &path)
+    {
+        FILE *in = fopen(path.c_str(), "rb");
+        if (!in)
+            return false;
+        std::vector<uint8_t> bytes;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+            bytes.insert(bytes.end(), buf, buf + n);
+        fclose(in);
+        return decode(bytes);
+    }
+};
+
+// Applies the replay events due before `tick` to the turn queue and game
+// settings. `next` is the index of the first event not yet applied.
+inline void applyReplayEvents(const Replay &replay, size_t &next, uint64_t tick,
+                              GameState &game, Direction dir, TurnQueue &turns, int &speedUs)
+{
+    while (next < replay.events.size() && replay.events[next].tick <= tick)
+    {
+        const ReplayEvent &event = replay.events[next++];
+        switch (event.code)
+        {
+        case 'w':
+            turns.push(dir, Direction::UP);
+            break;
+        case 's':
+            turns.push(dir, Direction::DOWN);
+            break;
+        case 'a':
+            turns.push(dir, Direction::LEFT);
+            break;
+        case 'd':
+            turns.push(dir, Direction::RIGHT);
+            break;
+        case 'F':
+            game.foodCount = static_cast<int>(event.value);
+            break;
+        case 'V':
+            speedUs = static_cast<int>(event.value);
+            break;
+        }
+    }
+}
+
+// Re-runs a replay on `game` as fast as possible. Returns the number of
+// engine steps taken; game.score can then be compared with replay.score.
+inline uint64_t simulateReplay(const Replay &replay, GameState &game)
+{
+    game.reset(replay.width, replay.height, replay.foodCount, replay.seed);
+    Direction dir = Direction::RIGHT;
+    TurnQueue turns;
+    int speedUs = replay.speedUs;
+    size_t next = 0;
+
+    uint64_t tick = 0;
+    for (; tick < replay.ticks && game.alive; ++tick)
+    {
+        applyReplayEvents(replay, next, tick, game, dir, turns, speedUs);
+        turns.pop(dir);
+        game.step(dir);
+    }
+    return tick;
+}
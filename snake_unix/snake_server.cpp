@@ -0,0 +1,402 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+
+#include "snake_arena.h"
+#include "snake_net.h"
+
+using namespace std;
+
+// Multiplayer server: one shared board, many snakes, one thread.
+// Build: g++ -O2 snake_server.cpp -o snake_server
+//
+// Clients connect to a Unix domain socket, get a welcome and a keyframe of
+// the board, and from then on one delta message per tick. A timerfd drives
+// the ticks and signalfd turns SIGINT/SIGTERM into an ordinary event, so
+// the whole server is a single epoll_wait loop. See snake_net.h for the
+// wire format.
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t MAX_CLIENT_BACKLOG = 1 << 20; // unsent bytes before a client is dropped
+constexpr uint64_t MAX_CATCH_UP = 3;           // ticks run at once after a stall
+constexpr int STATS_SECONDS = 5;
+
+struct ServerOptions
+{
+    string socketPath = "/tmp/snake.sock";
+    int width = 200, height = 100;
+    int foodCount = 32;
+    int hz = 20;
+    int maxClients = 1000;
+    uint64_t seed = 1;
+};
+
+struct Client
+{
+    int fd = -1;
+    uint16_t playerId = 0;
+    vector<uint8_t> out;
+    size_t sent = 0;
+    bool writeWatched = false;
+};
+
+struct Server
+{
+    ServerOptions options;
+    Arena arena;
+    int epollFd = -1, listenFd = -1, timerFd = -1, signalFd = -1;
+    vector<Client *> clients; // indexed by fd
+    size_t clientCount = 0;
+    bool running = true;
+
+    vector<uint8_t> tickMessage;
+    vector<CellChange> keyframe;
+
+    // Stats for the current reporting interval
+    uint64_t intervalTicks = 0, intervalBytes = 0, intervalDropped = 0;
+    double intervalTickUs = 0, intervalMaxTickUs = 0;
+    chrono::steady_clock::time_point intervalStart = chrono::steady_clock::now();
+
+    void watch(int fd, uint32_t events, int op = EPOLL_CTL_ADD)
+    {
+        epoll_event event = {};
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, op, fd, &event);
+    }
+
+    bool start()
+    {
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (options.socketPath.size() >= sizeof(address.sun_path))
+        {
+            fprintf(stderr, "socket path too long: %s\n", options.socketPath.c_str());
+            return false;
+        }
+        strcpy(address.sun_path, options.socketPath.c_str());
+        unlink(options.socketPath.c_str());
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+            listen(listenFd, SOMAXCONN) < 0)
+        {
+            perror(options.socketPath.c_str());
+            return false;
+        }
+
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        sigprocmask(SIG_BLOCK, &signals, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+        signalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        itimerspec period = {};
+        long periodNs = 1000000000L / options.hz;
+        period.it_interval.tv_sec = periodNs / 1000000000L;
+        period.it_interval.tv_nsec = periodNs % 1000000000L;
+        period.it_value = period.it_interval;
+        timerfd_settime(timerFd, 0, &period, nullptr);
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        watch(listenFd, EPOLLIN);
+        watch(timerFd, EPOLLIN);
+        watch(signalFd, EPOLLIN);
+
+        arena.reset(options.width, options.height, options.foodCount, options.seed);
+        arena.changes.clear();
+        return true;
+    }
+
+    void drop(Client *client)
+    {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, nullptr);
+        close(client->fd);
+        arena.leave(client->playerId);
+        clients[static_cast<size_t>(client->fd)] = nullptr;
+        clientCount--;
+        delete client;
+    }
+
+    // Writes as much of the client's backlog as the socket takes. Returns
+    // false if the client was dropped.
+    bool flush(Client *client)
+    {
+        while (client->sent < client->out.size())
+        {
+            ssize_t n = write(client->fd, client->out.data() + client->sent, client->out.size() - client->sent);
+            if (n > 0)
+            {
+                client->sent += static_cast<size_t>(n);
+                intervalBytes += static_cast<uint64_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno == EAGAIN)
+                break;
+            drop(client);
+            return false;
+        }
+
+        if (client->sent == client->out.size())
+        {
+            client->out.clear();
+            client->sent = 0;
+        }
+        else if (client->out.size() - client->sent > MAX_CLIENT_BACKLOG)
+        {
+            intervalDropped++;
+            drop(client);
+            return false;
+        }
+
+        bool wantWrite = client->sent < client->out.size();
+        if (wantWrite != client->writeWatched)
+        {
+            watch(client->fd, EPOLLIN | (wantWrite ? EPOLLOUT : 0u), EPOLL_CTL_MOD);
+            client->writeWatched = wantWrite;
+        }
+        return true;
+    }
+
+    void acceptClients()
+    {
+        while (true)
+        {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            if (clientCount >= static_cast<size_t>(options.maxClients))
+            {
+                close(fd);
+                continue;
+            }
+
+            Client *client = new Client;
+            client->fd = fd;
+            client->playerId = arena.join();
+            if (clients.size() <= static_cast<size_t>(fd))
+                clients.resize(static_cast<size_t>(fd) + 1, nullptr);
+            clients[static_cast<size_t>(fd)] = client;
+            clientCount++;
+            watch(fd, EPOLLIN);
+
+            // The keyframe already shows the new snake; the join itself stays
+            // in arena.changes for everyone else's next tick message.
+            MessageWriter welcome(client->out, MSG_WELCOME);
+            welcome.varint(client->playerId);
+            welcome.varint(static_cast<uint64_t>(arena.width));
+            welcome.varint(static_cast<uint64_t>(arena.height));
+            welcome.varint(static_cast<uint64_t>(1000000 / options.hz));
+            welcome.finish();
+
+            arena.snapshot(keyframe);
+            MessageWriter frame(client->out, MSG_KEYFRAME);
+            frame.varint(arena.tick);
+            frame.changes(keyframe.data(), keyframe.size());
+            frame.finish();
+            flush(client);
+        }
+    }
+
+    void readClient(Client *client)
+    {
+        char keys[256];
+        while (true)
+        {
+            ssize_t n = read(client->fd, keys, sizeof(keys));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0 && errno == EAGAIN)
+                return;
+            if (n <= 0)
+            {
+                drop(client);
+                return;
+            }
+            for (ssize_t i = 0; i < n; ++i)
+            {
+                if (keys[i] == 'q')
+                {
+                    drop(client);
+                    return;
+                }
+                arena.input(client->playerId, keys[i]);
+            }
+        }
+    }
+
+    void tick()
+    {
+        uint64_t expirations = 0;
+        if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations))
+            return;
+
+        for (uint64_t i = 0; i < min(expirations, MAX_CATCH_UP); ++i)
+        {
+            auto start = chrono::steady_clock::now();
+            arena.step();
+
+            // Encode the delta once, then queue the same bytes for everyone
+            tickMessage.clear();
+            MessageWriter message(tickMessage, MSG_TICK);
+            message.u64(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now().time_since_epoch()).count()));
+            message.varint(arena.tick);
+            message.changes(arena.changes.data(), arena.changes.size());
+            message.finish();
+            arena.changes.clear();
+
+            for (size_t fd = 0; fd < clients.size(); ++fd)
+            {
+                Client *client = clients[fd];
+                if (!client)
+                    continue;
+                client->out.insert(client->out.end(), tickMessage.begin(), tickMessage.end());
+                flush(client);
+            }
+
+            double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+            intervalTicks++;
+            intervalTickUs += us;
+            intervalMaxTickUs = max(intervalMaxTickUs, us);
+        }
+    }
+
+    void reportStats()
+    {
+        auto now = chrono::steady_clock::now();
+        double seconds = chrono::duration<double>(now - intervalStart).count();
+        if (seconds < STATS_SECONDS)
+            return;
+        fprintf(stderr, "clients %zu  ticks/s %.1f  tick avg %.0f us max %.0f us  out %.2f MB/s  dropped %llu\n",
+                clientCount, intervalTicks / seconds, intervalTicks ? intervalTickUs / intervalTicks : 0.0,
+                intervalMaxTickUs, intervalBytes / seconds / 1e6, static_cast<unsigned long long>(intervalDropped));
+        intervalTicks = intervalBytes = intervalDropped = 0;
+        intervalTickUs = intervalMaxTickUs = 0;
+        intervalStart = now;
+    }
+
+    void run()
+    {
+        epoll_event events[MAX_EVENTS];
+        while (running)
+        {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == listenFd)
+                    acceptClients();
+                else if (fd == timerFd)
+                    tick();
+                else if (fd == signalFd)
+                    running = false;
+                else if (static_cast<size_t>(fd) < clients.size() && clients[static_cast<size_t>(fd)])
+                {
+                    Client *client = clients[static_cast<size_t>(fd)];
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                        readClient(client);
+                    // The client may have been dropped (and its fd reused) by now
+                    client = clients[static_cast<size_t>(fd)];
+                    if (client && (events[i].events & EPOLLOUT))
+                        flush(client);
+                }
+            }
+            reportStats();
+        }
+    }
+
+    void stop()
+    {
+        for (Client *client : clients)
+        {
+            if (client)
+                drop(client);
+        }
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+    }
+};
+
+// Whether an Arena can hold a width x height board: the engine must be
+// able to index it and its per-cell arrays must fit in half of physical
+// memory.
+bool arenaFits(long long width, long long height)
+{
+    if (!validBoardSize(static_cast<uint64_t>(max(width, 0LL)), static_cast<uint64_t>(max(height, 0LL))))
+        return false;
+    uint64_t bytes = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * ARENA_BYTES_PER_CELL;
+    long pages = sysconf(_SC_PHYS_PAGES), pageSize = sysconf(_SC_PAGE_SIZE);
+    return pages <= 0 || pageSize <= 0 || bytes <= static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) / 2;
+}
+
+int main(int argc, char *argv[])
+{
+    Server server;
+    ServerOptions &options = server.options;
+    long long boardWidth = options.width, boardHeight = options.height;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            options.socketPath = argv[++i];
+        else if (arg == "--width" && hasValue)
+            boardWidth = strtoll(argv[++i], nullptr, 10);
+        else if (arg == "--height" && hasValue)
+            boardHeight = strtoll(argv[++i], nullptr, 10);
+        else if (arg == "--food" && hasValue)
+            options.foodCount = atoi(argv[++i]);
+        else if (arg == "--hz" && hasValue)
+            options.hz = atoi(argv[++i]);
+        else if (arg == "--max-clients" && hasValue)
+            options.maxClients = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "usage: %s [--socket PATH] [--width W] [--height H] [--food F] [--hz N]"
+                            " [--max-clients N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (boardWidth < 2 || boardHeight < 2 || options.foodCount < 0 || options.hz < 1 ||
+        options.maxClients < 1 || options.maxClients > UINT16_MAX - CELL_SNAKE)
+    {
+        fprintf(stderr, "the board must be at least 2x2, hz >= 1 and max-clients 1-%d\n", UINT16_MAX - CELL_SNAKE);
+        return 1;
+    }
+    if (!arenaFits(boardWidth, boardHeight))
+    {
+        fprintf(stderr, "a %lldx%lld board is too big for this machine\n", boardWidth, boardHeight);
+        return 1;
+    }
+    options.width = static_cast<int>(boardWidth);
+    options.height = static_cast<int>(boardHeight);
+
+    if (!server.start())
+        return 1;
+    fprintf(stderr, "serving a %dx%d board at %d Hz on %s\n", options.width, options.height, options.hz,
+            options.socketPath.c_str());
+    server.run();
+    server.stop();
+    return 0;
+}
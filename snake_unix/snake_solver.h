@@ -0,0 +1,191 @@
+#pragma once
+
+// Hamiltonian-cycle solver: plays perfect games by filling the board.
+//
+// build() lays one cycle through every cell of the board (a serpentine
+// over all but the first column or row, which is used to get back to the
+// start) and stores each cell's position on it. A snake that only ever
+// follows the cycle can not die: its body always lies in cycle order
+// behind the head, and the cells ahead of the head up to the tail are free.
+//
+// To get to food sooner the head may skip ahead along the cycle to any
+// neighbour that is still before the tail (and not past the nearest food).
+// The skipped cells stay free, so the body stays in cycle order, but they
+// are holes inside the body until the tail passes them. If the head ate
+// every free cell ahead of it before then, its only move left would be
+// into the tail. So a skip is only taken while there are no holes (every
+// free cell is ahead of the head) and the cells left ahead after it are
+// more than twice the body plus the food: eating all of them before the
+// tail has moved a body length would take food respawning in the head's
+// path almost every tick. The rule holds for the whole game; once the
+// body outgrows the free run ahead of it, no skip is allowed. The sweep in
+// snake_bench checks every board up to 12x12 against it.
+//
+// A snake can only be handed to the solver while its body lies in cycle
+// order (see inCycleOrder()); until then the front end keeps steering with
+// the autopilot. choose() never turns a snake back on itself, so a new
+// game played by the solver alone should start heading onward[head].
+//
+// choose() is O(1) per tick: when no skip is allowed the answer is the
+// precomputed direction to the next cell on the cycle, otherwise it looks
+// at four neighbours and the food positions.
+
+#include <cstdint>
+#include <vector>
+
+#include "snake_engine.h"
+
+constexpr uint32_t SHORTCUT_MARGIN = 3; // free cycle cells kept in front of the tail
+
+struct HamiltonianSolver
+{
+    int width = 0, height = 0;
+    uint32_t area = 0;
+    bool valid = false;            // false if the board has no Hamiltonian cycle
+    std::vector<uint32_t> order;   // cell index -> position on the cycle
+    std::vector<Direction> onward; // cell index -> direction of the next cell on the cycle
+
+    // A grid has a Hamiltonian cycle iff it has an even number of cells.
+    bool build(int boardWidth, int boardHeight)
+    {
+        width = boardWidth;
+        height = boardHeight;
+        area = static_cast<uint32_t>(width) * static_cast<uint32_t>(height);
+        valid = width >= 2 && height >= 2 && area % 2 == 0;
+        if (!valid)
+            return false;
+
+        order.assign(area, 0);
+        bool rowsEven = height % 2 == 0;
+        // Serpentine over the "lanes" (rows if rowsEven), skipping their
+        // first cell, then back along the first column (or row).
+        int lanes = rowsEven ? height : width;
+        int laneLength = rowsEven ? width : height;
+        auto cellOf = [&](int lane, int along)
+        {
+            int row = rowsEven ? lane : along;
+            int col = rowsEven ? along : lane;
+            return static_cast<uint32_t>(row) * static_cast<uint32_t>(width) + static_cast<uint32_t>(col);
+        };
+
+        uint32_t position = 0;
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            for (int i = 1; i < laneLength; ++i)
+            {
+                int along = lane % 2 == 0 ? i : laneLength - i;
+                order[cellOf(lane, along)] = position++;
+            }
+        }
+        for (int lane = lanes - 1; lane >= 0; --lane)
+            order[cellOf(lane, 0)] = position++;
+
+        std::vector<uint32_t> cellAt(area);
+        for (uint32_t cell = 0; cell < area; ++cell)
+            cellAt[order[cell]] = cell;
+        onward.assign(area, Direction::RIGHT);
+        for (uint32_t i = 0; i < area; ++i)
+        {
+            uint32_t from = cellAt[i], to = cellAt[(i + 1) % area];
+            if (to + static_cast<uint32_t>(width) == from)
+                onward[from] = Direction::UP;
+            else if (from + static_cast<uint32_t>(width) == to)
+                onward[from] = Direction::DOWN;
+            else if (to + 1 == from)
+                onward[from] = Direction::LEFT;
+        }
+        return true;
+    }
+
+    // Sets up the cycle for a new game's board if its size changed.
+    void reset(const GameState &game)
+    {
+        if (game.width != width || game.height != height)
+            build(game.width, game.height);
+    }
+
+    // Steps needed to get from `from` to `to` following the cycle.
+    uint32_t ahead(uint32_t from, uint32_t to) const
+    {
+        uint32_t a = order[to], b = order[from];
+        return a >= b ? a - b : a + area - b;
+    }
+
+    // Whether following the cycle from here is safe: walking the body from
+    // the tail to the head only ever moves forward along the cycle, less
+    // than one lap in all, and leaves the head at least two cells behind
+    // the tail so the next cycle cell is free. A one-segment snake must not
+    // be heading against the cycle, as it can not turn round. O(length).
+    bool inCycleOrder(const GameState &game, Direction current) const
+    {
+        size_t length = game.length();
+        if (!valid || length == 1)
+            return valid && !isReverse(current, onward[game.snake.front()]);
+        uint64_t travelled = 0;
+        for (size_t i = length - 1; i > 0; --i)
+            travelled += ahead(game.snake[i], game.snake[i - 1]);
+        return travelled + 2 <= area;
+    }
+
+    Direction choose(const GameState &game, Direction current) const
+    {
+        uint32_t head = game.snake.front();
+        uint32_t length = static_cast<uint32_t>(game.length());
+        uint32_t gap = length == 1 ? area : ahead(head, game.snake.back());
+
+        // Skips are allowed only while every free cell is ahead of the head
+        // (no skipped cell is still inside the body) and the tail stays
+        // further ahead than twice the body and food, plus a margin
+        uint32_t room = 2 * (length + static_cast<uint32_t>(game.foodCount)) + SHORTCUT_MARGIN;
+        bool holes = gap - 1 < area - length;
+        if (holes || gap <= room + 1)
+        {
+            // A one-segment snake may be heading against the cycle
+            if (gap >= 2 && !isReverse(current, onward[head]))
+                return onward[head];
+            return furthestWithin(game, current, head, 1);
+        }
+
+        // How far ahead along the cycle the head may jump this tick
+        uint32_t limit = gap - room - 1;
+        for (const auto &food : game.foodPositions)
+        {
+            uint32_t toFood = ahead(head, game.cellIndex(food));
+            if (toFood < gap && toFood < limit)
+                limit = toFood;
+        }
+        return furthestWithin(game, current, head, limit);
+    }
+
+    // The free neighbour furthest along the cycle within `limit` steps of
+    // the head, or else the free one that goes least far past it.
+    Direction furthestWithin(const GameState &game, Direction current, uint32_t head, uint32_t limit) const
+    {
+        static const Direction options[] = {Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT};
+        static const int dRow[] = {-1, 1, 0, 0};
+        static const int dCol[] = {0, 0, -1, 1};
+
+        std::pair<int, int> pos = game.cellPos(head);
+        Direction best = current;
+        uint32_t bestAhead = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            int row = pos.first + dRow[i], col = pos.second + dCol[i];
+            if (!game.inBounds(row, col) || isReverse(current, options[i]))
+                continue;
+            uint32_t cell = game.cellIndex({row, col});
+            if (game.cells[cell] == Cell::SNAKE)
+                continue;
+
+            // Farthest jump within the limit; anything free beats nothing
+            uint32_t step = ahead(head, cell);
+            uint32_t score = step <= limit ? step + area : area - step;
+            if (score > bestAhead)
+            {
+                bestAhead = score;
+                best = options[i];
+            }
+        }
+        return best;
+    }
+};
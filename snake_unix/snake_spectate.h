@@ -0,0 +1,229 @@
+#pragma once
+
+// Spectator fan-out for the terminal front end.
+//
+// With --spectate the game also listens on a Unix domain socket. Each
+// frame's diff (the escape sequences present() produced for the player's
+// terminal) is copied once into a reference-counted buffer, and every
+// viewer's queue just holds a reference to it. Queues are sent with one
+// sendmsg() per viewer whose iovecs point straight into those shared
+// buffers, so the per-viewer cost is a syscall, not a render or a copy.
+//
+// Sockets are non-blocking and nothing here ever waits. A viewer whose
+// backlog passes SPECTATOR_MAX_BACKLOG has its queued diffs thrown away
+// and gets a keyframe (a full repaint of the current screen) instead,
+// which also is what a new viewer starts with. The keyframe is built at
+// most once per frame and shared the same way. A frame that is partly
+// sent is always finished first, so no escape sequence is cut in half.
+//
+// The stream is plain terminal output: snake_viewer only has to copy it
+// to its own terminal.
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "snake_render.h"
+
+constexpr size_t SPECTATOR_MAX_BACKLOG = 256 * 1024;
+constexpr size_t SPECTATOR_MAX_IOV = 64;
+
+using SharedFrame = std::shared_ptr<const std::string>;
+
+struct Viewer
+{
+    int fd = -1;
+    std::deque<SharedFrame> queue;
+    size_t sent = 0;        // bytes of queue.front() already written
+    size_t queuedBytes = 0; // unsent bytes across the queue
+    bool needsKeyframe = true;
+};
+
+struct SpectatorHub
+{
+    std::string socketPath;
+    int listenFd = -1;
+    std::vector<Viewer> viewers;
+
+    // Totals since start-up
+    unsigned long frames = 0, keyframes = 0, skips = 0, sendCalls = 0, bytesSent = 0;
+
+    bool listening() const { return listenFd >= 0; }
+
+    bool listen(const std::string &path)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+        strcpy(address.sun_path, path.c_str());
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        unlink(path.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            return false;
+        }
+        listenFd = fd;
+        socketPath = path;
+        return true;
+    }
+
+    void stop()
+    {
+        for (Viewer &viewer : viewers)
+            ::close(viewer.fd);
+        viewers.clear();
+        if (listenFd >= 0)
+        {
+            ::close(listenFd);
+            unlink(socketPath.c_str());
+            listenFd = -1;
+        }
+    }
+
+    void acceptViewers()
+    {
+        while (true)
+        {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            Viewer viewer;
+            viewer.fd = fd;
+            viewers.push_back(std::move(viewer));
+        }
+    }
+
+    // Sends everyone a keyframe with the next frame, e.g. after the
+    // player's terminal was cleared outside of present().
+    void requestKeyframes()
+    {
+        for (Viewer &viewer : viewers)
+            viewer.needsKeyframe = true;
+    }
+
+    void enqueue(Viewer &viewer, const SharedFrame &frame)
+    {
+        viewer.queue.push_back(frame);
+        viewer.queuedBytes += frame->size();
+    }
+
+    // Drops every queued diff except a partly sent one and queues `keyframe`.
+    void skipToKeyframe(Viewer &viewer, const SharedFrame &keyframe)
+    {
+        size_t keep = viewer.sent > 0 ? 1 : 0;
+        while (viewer.queue.size() > keep)
+        {
+            viewer.queuedBytes -= viewer.queue.back()->size();
+            viewer.queue.pop_back();
+        }
+        enqueue(viewer, keyframe);
+        viewer.needsKeyframe = false;
+    }
+
+    // Sends as much of the viewer's queue as the socket takes without
+    // blocking. Returns false if the viewer has gone away.
+    bool send(Viewer &viewer)
+    {
+        while (!viewer.queue.empty())
+        {
+            iovec iov[SPECTATOR_MAX_IOV];
+            size_t count = 0;
+            for (const SharedFrame &frame : viewer.queue)
+            {
+                if (count == SPECTATOR_MAX_IOV)
+                    break;
+                size_t skip = count == 0 ? viewer.sent : 0;
+                iov[count].iov_base = const_cast<char *>(frame->data() + skip);
+                iov[count].iov_len = frame->size() - skip;
+                count++;
+            }
+
+            msghdr message = {};
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+            ssize_t n = sendmsg(viewer.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+            sendCalls++;
+            if (n < 0)
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+            size_t written = static_cast<size_t>(n);
+            bytesSent += written;
+            viewer.queuedBytes -= written;
+            while (written > 0)
+            {
+                size_t left = viewer.queue.front()->size() - viewer.sent;
+                if (written < left)
+                {
+                    viewer.sent += written;
+                    break;
+                }
+                written -= left;
+                viewer.sent = 0;
+                viewer.queue.pop_front();
+            }
+        }
+        return true;
+    }
+
+    // Fans one frame out to every viewer. `diff` is what present() appended
+    // for this frame; `screen` supplies keyframes.
+    void publish(const FrameBuffer &screen, const char *diff, size_t size)
+    {
+        acceptViewers();
+        if (viewers.empty())
+            return;
+        frames++;
+
+        SharedFrame frame, keyframe;
+        if (size > 0)
+            frame = std::make_shared<const std::string>(diff, size);
+
+        for (size_t i = 0; i < viewers.size();)
+        {
+            Viewer &viewer = viewers[i];
+            if (viewer.needsKeyframe)
+            {
+                if (!keyframe)
+                {
+                    std::string bytes;
+                    screen.repaint(bytes);
+                    keyframe = std::make_shared<const std::string>(std::move(bytes));
+                    keyframes++;
+                }
+                skipToKeyframe(viewer, keyframe);
+            }
+            else if (frame)
+            {
+                enqueue(viewer, frame);
+            }
+
+            if (!send(viewer))
+            {
+                ::close(viewer.fd);
+                viewers[i] = std::move(viewers.back());
+                viewers.pop_back();
+                continue;
+            }
+
+            // Too far behind: catch up with a keyframe next frame instead
+            if (viewer.queuedBytes > SPECTATOR_MAX_BACKLOG)
+            {
+                viewer.needsKeyframe = true;
+                skips++;
+            }
+            ++i;
+        }
+    }
+};
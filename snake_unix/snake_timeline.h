@@ -0,0 +1,60 @@
+#pragma once
+
+// Timed callbacks for the front end's event loop.
+//
+// Menus and their animations (the game-over blink, the restart countdown,
+// "Color changed!" notices) schedule entries here instead of sleeping.
+// The event loop in snake_unix.cpp sleeps in ppoll() until the earliest
+// entry is due or a key arrives, so a paused or idle game wakes up only
+// when there is something to draw.
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "snake_clock.h"
+
+struct Timeline
+{
+    struct Entry
+    {
+        GameClock::time_point at;
+        uint64_t order; // entries due at the same time run in the order scheduled
+        std::function<void()> run;
+    };
+
+    std::vector<Entry> entries; // min-heap on (at, order)
+    uint64_t scheduled = 0;
+
+    static bool later(const Entry &a, const Entry &b)
+    {
+        return a.at != b.at ? a.at > b.at : a.order > b.order;
+    }
+
+    bool empty() const { return entries.empty(); }
+    GameClock::time_point next() const { return entries.empty() ? GameClock::time_point::max() : entries.front().at; }
+
+    void at(GameClock::time_point when, std::function<void()> run)
+    {
+        entries.push_back({when, scheduled++, std::move(run)});
+        std::push_heap(entries.begin(), entries.end(), later);
+    }
+
+    void after(GameClock::duration delay, std::function<void()> run) { at(GameClock::now() + delay, std::move(run)); }
+
+    void clear() { entries.clear(); }
+
+    // Runs every entry due by `now`, earliest first. An entry may schedule
+    // more; those run in this call too if they are already due.
+    void runDue(GameClock::time_point now)
+    {
+        while (!entries.empty() && entries.front().at <= now)
+        {
+            std::pop_heap(entries.begin(), entries.end(), later);
+            Entry entry = std::move(entries.back());
+            entries.pop_back();
+            entry.run();
+        }
+    }
+};
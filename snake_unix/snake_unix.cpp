@@ -1,28 +1,88 @@
 #include <iostream>
 #include <vector>
-#include <unordered_set>
 #include <ctime>
 #include <chrono>
 #include <unistd.h>
 #include <termios.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <poll.h>
+#include <thread>
+#include <atomic>
 #include <algorithm>
+#include <csignal>
+#include <cerrno>
+
+#include "snake_engine.h"
+#include "snake_render.h"
+#include "snake_clock.h"
+#include "snake_input.h"
+#include "snake_latency.h"
+#include "snake_profile.h"
+#include "snake_replay.h"
+#include "snake_autopilot.h"
+#include "snake_solver.h"
+#include "snake_spectate.h"
+#include "snake_camera.h"
+#include "snake_world.h"
+#include "snake_timeline.h"
+#include "snake_core.h"
 
 using namespace std;
 
 // Constants
-constexpr int MAX_SNAKE_LENGTH = 1000;
 constexpr int DEFAULT_BORDER_WIDTH = 60;
 constexpr int DEFAULT_BORDER_HEIGHT = 20;
-constexpr int MAX_ATTEMPTS = 500;
+constexpr int GAME_OVER_BLINKS = 6;
+constexpr auto GAME_OVER_BLINK_PERIOD = chrono::milliseconds(300);
+constexpr int RESTART_COUNTDOWN = 3; // seconds
+constexpr auto NOTICE_DURATION = chrono::milliseconds(1500);
 
 // Game State
 int borderWidth = DEFAULT_BORDER_WIDTH;
 int borderHeight = DEFAULT_BORDER_HEIGHT;
 int rows = 0, cols = 0;
-unsigned int score = 0;
-bool run = true, playerLost = false;
+bool playerLost = false;
+FrameBuffer screen;
+FrameOutput frameOutput;
+
+// The game loop is GameCore's (snake_core.h), shared with the other builds.
+// These policies plug this front end into it; they are defined next to
+// gameLoop() below.
+struct UnixTerminal
+{
+    void clear(const GameState &);
+    void cell(pair<int, int> pos, Cell what);
+    void present(const GameState &);
+};
+
+struct UnixClock
+{
+    int ticksDue = 1; // more than one only when the previous frame overran
+    void start();
+    void wait();
+};
+
+struct UnixInput
+{
+    template <typename F>
+    void poll(F &&);
+};
+
+struct UnixHooks;
+using UnixCore = GameCore<UnixTerminal, UnixClock, UnixInput, UnixHooks>;
+
+struct UnixHooks
+{
+    void beforeStep(UnixCore &core);
+    void turned(UnixCore &core, GameClock::time_point pressed);
+    StepResult step(UnixCore &core);
+    bool afterStep(UnixCore &core, const StepResult &result);
+};
+
+UnixCore core;
+GameState &game = core.game;
+bool &run = core.running;
 
 // Terminal Settings
 struct termios original_termios;
@@ -32,49 +92,82 @@ int snakeSpeed = 150000;
 string snakeColor = "\033[32m";
 string foodColor = "\033[31m";
 int foodCount = 1;
-vector<pair<int, int>> foodPositions;
 
-// Snake Data Structures
-pair<int, int> snakeBuffer[MAX_SNAKE_LENGTH];
-int head = 0, tail = 0, snakeSize = 0;
+// Colour themes for --theme; the settings menu can still swap the snake and
+// food colours for one of the basic ones.
+struct Theme
+{
+    const char *name;
+    string snake, food, info, warning;
+};
+const Theme themes[] = {
+    {"basic", sgrColor(32), sgrColor(31), sgrColor(36), sgrColor(31)},
+    {"256", sgrColor256(46), sgrColor256(196), sgrColor256(45), sgrColor256(208)},
+    {"truecolor", sgrTrueColor(80, 220, 100), sgrTrueColor(255, 85, 85), sgrTrueColor(90, 200, 255), sgrTrueColor(255, 170, 0)},
+};
+const Theme *theme = &themes[0];
 
-enum class Direction{ UP, DOWN, LEFT, RIGHT };
-Direction dir = Direction::RIGHT;
+// Framebuffer style ids, see applyColors()
+enum Style : uint8_t { STYLE_DEFAULT, STYLE_SNAKE, STYLE_FOOD, STYLE_INFO, STYLE_WARNING };
 
-// Clock For Timer
-chrono::steady_clock::time_point gameStart;
-chrono::steady_clock::time_point pauseStart;
-chrono::steady_clock::duration totalPausedTime = chrono::seconds(0);
+Direction &dir = core.dir;
+TurnQueue &turns = core.turns;
 
-struct pairHash
-{
-    size_t operator()(const pair<int, int> &p) const
-    {
-        return hash<int>()(p.first) ^ (hash<int>()(p.second) << 1);
-    }
-};
+// Input Reader
+// A background thread owns stdin: it decodes keys into keyQueue and pokes
+// wakePipe so the game loop can sleep in poll() until a key or its deadline.
+KeyQueue keyQueue;
+thread inputThread;
+atomic<bool> inputThreadRunning{false};
+int wakePipe[2] = {-1, -1};
+int stopPipe[2] = {-1, -1};
 
-unordered_set<pair<int, int>, pairHash> snakeBody;
+// Terminal resizes: the SIGWINCH handler only writes a byte here, and the
+// wait loop polls it next to wakePipe and lays the screen out again.
+int resizePipe[2] = {-1, -1};
 
-int mod(int x) { return (x + MAX_SNAKE_LENGTH) % MAX_SNAKE_LENGTH; }
+// Menu animations and notices, run by waitForEvent() as they fall due
+Timeline timeline;
 
-void push_front(pair<int, int> pos)
-{
-    head = mod(head - 1);
-    snakeBuffer[head] = pos;
-    snakeSize++;
-    snakeBody.insert(pos);
-}
+// Keypress-to-photon latency, collected with --latency and reported at exit
+LatencyTracker latency;
 
-void pop_back()
-{
-    tail = mod(tail - 1);
-    snakeBody.erase(snakeBuffer[tail]);
-    snakeSize--;
-}
+// Per-frame timings, shown with the 'p' key and dumped with --profile-csv
+FrameProfiler profiler;
+bool pausedThisFrame = false;
+
+// Replays: every game is recorded, --record saves it and --replay plays one back
+Replay recording;
+string recordPath;
+Replay playback;
+bool playingBack = false;
+size_t playbackNext = 0;
+uint64_t &gameTicks = core.ticks;
 
-pair<int, int> get_front() { return snakeBuffer[head]; }
-pair<int, int> get_back() { return snakeBuffer[mod(tail - 1)]; }
+// Autopilot (O key or --autopilot)
+Autopilot autopilot;
+bool autopilotOn = false;
+
+// Hamiltonian-cycle solver (H key or --solver)
+HamiltonianSolver solver;
+bool solverOn = false;
+bool solverEngaged = false; // the body lies on the cycle and the solver is steering
+
+// Viewers watching over --spectate
+SpectatorHub spectators;
+
+// The part of the board on screen; boards bigger than the terminal scroll
+Camera camera;
+
+// Board without walls (--infinite), played on `world` instead of `game`
+ChunkWorld world;
+bool infiniteBoard = false;
+
+// Clock For Timer
+TickClock tickClock;
+GameClock::time_point gameStart;
+GameClock::time_point pauseStart;
+GameClock::duration totalPausedTime = chrono::seconds(0);
 
 // Terminal Control
 void clearTerminal() { printf("\033[H\033[J"); }
@@ -92,11 +185,51 @@ void getTerminalSize(int &rows, int &cols)
     }
 }
 
+void onWindowResize(int)
+{
+    int savedErrno = errno;
+    if (write(resizePipe[1], "r", 1) < 0)
+    {
+        // pipe full: a resize is already pending
+    }
+    errno = savedErrno;
+}
+
+void watchWindowSize()
+{
+    if (pipe2(resizePipe, O_NONBLOCK | O_CLOEXEC) < 0)
+        return;
+
+    struct sigaction action = {};
+    action.sa_handler = onWindowResize;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGWINCH, &action, nullptr);
+}
+
+// True (once) if the terminal was resized since the last call.
+bool windowResized()
+{
+    char drain[64];
+    bool resized = false;
+    while (read(resizePipe[0], drain, sizeof(drain)) > 0)
+        resized = true;
+    return resized;
+}
+
+void stopInputThread();
+
 void restoreTerminalSettings()
 {
+    stopInputThread();
+    spectators.stop();
     clearTerminal();
     tcsetattr(STDIN_FILENO, TCSANOW, &original_termios);
     printf("\033[?25h");
+    if (latency.enabled)
+        latency.report(stdout);
+    if (!profiler.csvPath.empty() && !profiler.dumpCsv())
+        printf("Could not write %s\n", profiler.csvPath.c_str());
     fflush(stdout);
 }
 
@@ -115,212 +248,543 @@ void setNonBlockingInput()
     fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
 }
 
-char getInput()
+// Board cells outside the camera's window are not on screen and are skipped.
+void putCell(pair<int, int> cell, char ch, uint8_t style)
 {
-    char ch;
-    if (read(STDIN_FILENO, &ch, 1) == 1)
+    if (camera.visible(cell))
+        screen.put(camera.screenRow(cell.first), camera.screenCol(cell.second), ch, style);
+}
+
+unsigned int currentScore() { return infiniteBoard ? world.score : game.score; }
+
+void applyColors()
+{
+    screen.styles = {"", snakeColor, foodColor, theme->info, theme->warning};
+}
+
+// 1-4 for the levels offered by changeSnakeSpeed(), 0 for the default speed.
+int speedLevel()
+{
+    switch (snakeSpeed)
+    {
+    case 500000:
+        return 1;
+    case 250000:
+        return 2;
+    case 100000:
+        return 3;
+    case 50000:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// Sends everything that changed in the framebuffer since the last frame
+// as one write(), after anything the menus left in the stdio buffers.
+void presentFrame()
+{
+    cout.flush();
+    fflush(stdout);
+
+    frameOutput.begin();
+    screen.present(frameOutput.bytes);
+    if (spectators.listening())
+        spectators.publish(screen, frameOutput.bytes.data() + frameOutput.prefixSize,
+                           frameOutput.bytes.size() - frameOutput.prefixSize);
+    frameOutput.flush(STDOUT_FILENO);
+
+    if (latency.enabled && !latency.pending.empty())
+        latency.written(GameClock::now(), speedLevel());
+}
+
+// Asks the terminal whether it knows DEC mode 2026 (DECRQM) and waits
+// briefly for the reply. Terminals that ignore the query stay unsynchronized.
+bool detectSynchronizedOutput()
+{
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+        return false;
+
+    const char query[] = "\033[?2026$p";
+    if (write(STDOUT_FILENO, query, sizeof(query) - 1) < 0)
+        return false;
+
+    // Expected reply: ESC [ ? 2026 ; Ps $ y, where Ps 1 or 2 means supported
+    string reply;
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    while (reply.find('y') == string::npos && poll(&pfd, 1, 100) > 0)
     {
-        if (ch == '\033') // possible ESC or arrow key
+        char buf[32];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+        reply.append(buf, static_cast<size_t>(n));
+    }
+
+    size_t pos = reply.find("\033[?2026;");
+    if (pos == string::npos || pos + 8 >= reply.size())
+        return false;
+    char mode = reply[pos + 8];
+    return mode == '1' || mode == '2';
+}
+
+void inputReaderLoop()
+{
+    InputDecoder decoder;
+    while (inputThreadRunning)
+    {
+        int timeout = -1;
+        if (decoder.escapePending())
         {
-            // Wait 30ms to see if more characters follow
-            usleep(30000);
+            auto remaining = chrono::duration_cast<chrono::milliseconds>(decoder.escapeDeadline() - GameClock::now());
+            timeout = remaining.count() > 0 ? static_cast<int>(remaining.count()) + 1 : 0;
+        }
 
-            char seq[2];
-            int n = read(STDIN_FILENO, seq, 2);
+        struct pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents)
+            break;
 
-            if (n == 0)
-            {
-                return '\033'; // ESC key pressed
-            }
-            else if (n == 2 && seq[0] == '[')
-            {
-                switch (seq[1])
-                {
-                case 'A':
-                    return 'w'; // Up
-                case 'B':
-                    return 's'; // Down
-                case 'C':
-                    return 'd'; // Right
-                case 'D':
-                    return 'a'; // Left
-                }
-            }
+        char buf[64];
+        ssize_t n;
+        while ((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0)
+            decoder.feed(buf, static_cast<size_t>(n), GameClock::now());
+        auto readAt = GameClock::now();
+        decoder.expire(readAt);
+
+        bool pushed = false;
+        for (char ch = decoder.next(); ch; ch = decoder.next())
+            pushed |= keyQueue.push({ch, readAt});
+        if (pushed && write(wakePipe[1], "k", 1) < 0)
+        {
+            // pipe full: the game loop already has a wake-up pending
         }
-        return ch;
     }
-    return '\0';
 }
 
-void drawBorders(int top, int left)
+void startInputThread()
 {
-    string border(static_cast<size_t>(borderWidth), '_');
-    moveCursorTo(top - 1, left);
-    cout << border;
-    moveCursorTo(top + borderHeight, left);
-    cout << border;
+    if (pipe(wakePipe) < 0 || pipe(stopPipe) < 0)
+        return;
+    for (int fd : {wakePipe[0], wakePipe[1]})
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    inputThreadRunning = true;
+    inputThread = thread(inputReaderLoop);
+}
 
-    for (int i = 0; i <= borderHeight; i++)
+void stopInputThread()
+{
+    if (!inputThreadRunning)
+        return;
+    inputThreadRunning = false;
+    if (write(stopPipe[1], "s", 1) < 0)
     {
-        moveCursorTo(top + i, left);
-        cout << "|";
-        moveCursorTo(top + i, left + borderWidth);
-        cout << "|";
+        // the reader will notice inputThreadRunning on its next wake-up
     }
-    cout.flush();
+    if (inputThread.joinable())
+        inputThread.join();
 }
 
-void drawSidebar(int top, int left)
+// Takes the next key the reader thread has queued, if any.
+KeyEvent nextKey()
 {
-    moveCursorTo(top, 2);
-    cout << "\033[36m=== INFO ===\033[0m";
+    char drain[64];
+    while (read(wakePipe[0], drain, sizeof(drain)) > 0)
+    {
+    }
+    return keyQueue.pop();
+}
 
-    moveCursorTo(top + 2, 2);
-    cout << "Score: " << score;
+// Returned by waitForEvent() when the terminal was resized. Ctrl-Z stops
+// the game (ISIG stays on), so it never arrives as a key.
+constexpr char KEY_RESIZE = 0x1A;
 
-    auto now = chrono::steady_clock::now();
-    auto playTime = chrono::duration_cast<chrono::seconds>(now - gameStart - totalPausedTime);
+// The one place the front end sleeps: in ppoll() until a key arrives, the
+// terminal is resized, the next timeline entry falls due or `deadline`
+// passes. Runs due timeline entries and returns the next key, KEY_RESIZE,
+// or an empty event at the deadline. With takeKeys false, keys are left
+// queued for whoever reads them next.
+KeyEvent waitForEvent(GameClock::time_point deadline = GameClock::time_point::max(), bool takeKeys = true)
+{
+    while (true)
+    {
+        timeline.runDue(GameClock::now());
+        if (takeKeys)
+        {
+            KeyEvent event = nextKey();
+            if (event.key)
+                return event;
+        }
+        if (windowResized())
+            return {KEY_RESIZE, GameClock::now()};
+
+        auto now = GameClock::now();
+        if (now >= deadline)
+            return {};
+
+        // No deadline and nothing scheduled: sleep until a key or a resize
+        auto wakeAt = min(deadline, timeline.next());
+        struct timespec ts;
+        struct timespec *timeout = nullptr;
+        if (wakeAt != GameClock::time_point::max())
+        {
+            auto wait = chrono::duration_cast<chrono::nanoseconds>(max(wakeAt - now, GameClock::duration::zero()));
+            ts.tv_sec = static_cast<time_t>(wait.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(wait.count() % 1000000000);
+            timeout = &ts;
+        }
+        struct pollfd fds[2] = {{takeKeys ? wakePipe[0] : -1, POLLIN, 0}, {resizePipe[0], POLLIN, 0}};
+        ppoll(fds, 2, timeout, nullptr);
+    }
+}
+
+char waitForKey() { return waitForEvent().key; }
+
+void handleInput(char ch, GameClock::time_point readAt = GameClock::now());
+void relayout();
+
+// Handles keys and resizes until the next tick is due. Re-reads the
+// deadline every time round since the pause menu restarts the clock.
+void waitForNextTick()
+{
+    while (run)
+    {
+        KeyEvent event = waitForEvent(tickClock.nextTick);
+        if (!event.key)
+            return;
+
+        // Show the new layout now rather than at the next tick
+        if (event.key == KEY_RESIZE)
+        {
+            relayout();
+            presentFrame();
+        }
+        else
+        {
+            handleInput(event.key, event.readAt);
+        }
+    }
+}
+
+// Frames the camera's window. Edges where the board carries on past the
+// window are dotted instead of solid.
+void drawBorders()
+{
+    int top = camera.screenTop, left = camera.screenLeft - 1;
+    int right = camera.screenLeft + camera.viewCols;
+    screen.text(top - 1, left, string(static_cast<size_t>(camera.viewCols + 1), camera.moreAbove() ? '.' : '_'));
+    screen.text(top + camera.viewRows, left, string(static_cast<size_t>(camera.viewCols + 1), camera.moreBelow() ? '.' : '_'));
+
+    for (int i = 0; i <= camera.viewRows; i++)
+    {
+        screen.put(top + i, left, camera.moreLeft() ? ':' : '|');
+        screen.put(top + i, right, camera.moreRight() ? ':' : '|');
+    }
+}
+
+string formatNs(double ns)
+{
+    char text[32];
+    if (ns >= 1000000)
+        snprintf(text, sizeof(text), "%.2fms", ns / 1000000);
+    else
+        snprintf(text, sizeof(text), "%.1fus", ns / 1000);
+    return text;
+}
+
+// Rolling per-frame averages under the sidebar, or blanks when hidden.
+void drawProfilePanel(int top)
+{
+    const int width = 16;
+    string lines[7] = {"-- PROFILE --"};
+    if (profiler.showPanel)
+    {
+        char text[32];
+        lines[1] = "Sim:    " + formatNs(profiler.avgSimNs);
+        lines[2] = "Render: " + formatNs(profiler.avgRenderNs);
+        snprintf(text, sizeof(text), "Bytes:  %.0f", profiler.avgBytes);
+        lines[3] = text;
+        snprintf(text, sizeof(text), "Writes: %.2f", profiler.avgWrites);
+        lines[4] = text;
+        lines[5] = "Sleep:  " + formatNs(profiler.avgSleepNs);
+        lines[6] = "Late:   " + formatNs(profiler.avgLateNs);
+    }
+
+    for (int i = 0; i < 7; ++i)
+    {
+        string line = profiler.showPanel ? lines[i] : "";
+        line.resize(width, ' ');
+        screen.text(top + i, 2, line);
+    }
+}
+
+void drawSidebar()
+{
+    int top = camera.screenTop;
+    screen.text(top, 2, "=== INFO ===", STYLE_INFO);
+
+    screen.text(top + 2, 2, "Score: " + to_string(currentScore()));
+
+    auto playTime = chrono::duration_cast<chrono::seconds>(tickClock.lastTick - gameStart - totalPausedTime);
     int minutes = playTime.count() / 60;
     int seconds = playTime.count() % 60;
 
-    moveCursorTo(top + 4, 2);
-    printf("Time: %02d:%02d", minutes, seconds);
+    char timeText[32];
+    snprintf(timeText, sizeof(timeText), "Time: %02d:%02d", minutes, seconds);
+    screen.text(top + 4, 2, timeText);
 
-    cout.flush();
+    char jitterText[32];
+    snprintf(jitterText, sizeof(jitterText), "Jitter: %.1fms ", tickClock.jitterAvgUs / 1000);
+    screen.text(top + 6, 2, jitterText);
+
+    drawProfilePanel(top + 8);
+
+    // Food is rarely on screen without walls, so point at the nearest item
+    if (infiniteBoard)
+    {
+        string hint = "Food: none";
+        pair<int, int> head = world.get_front();
+        long best = -1;
+        for (const auto &food : world.foodPositions)
+        {
+            int dRow = food.first - head.first, dCol = food.second - head.second;
+            long distance = abs(dRow) + abs(dCol);
+            if (best >= 0 && distance >= best)
+                continue;
+            best = distance;
+            hint = "Food: " + to_string(abs(dRow)) + (dRow < 0 ? "N " : "S ") + to_string(abs(dCol)) + (dCol < 0 ? "W" : "E");
+        }
+        hint.resize(16, ' ');
+        screen.text(top + 16, 2, hint);
+    }
 }
 
+// The blink and the restart countdown are timeline entries, so the screen
+// sleeps in poll() between frames and takes a choice or a resize at any point.
 bool gameOverScreen()
 {
-    clearTerminal();
-    int centerRow = rows / 2;
-    int centerCol = cols / 2 - 10;
+    int blinkFrame = 0; // the menu shows once this reaches GAME_OVER_BLINKS
+    int countdown = 0;  // seconds to the restart once it is chosen
 
-    // Blinking GAME OVER animation
-    for (int i = 0; i < 6; ++i)
+    auto draw = [&]()
     {
-        moveCursorTo(centerRow, centerCol);
-        if (i % 2 == 0)
-            cout << "\033[5;31m=== GAME OVER ===\033[0m";
-        else
-            cout << "                  ";
+        int centerRow = rows / 2;
+        int centerCol = cols / 2 - 10;
+        clearTerminal();
 
-        cout.flush();
-        usleep(300000);
-    }
+        // Blinking GAME OVER animation
+        if (blinkFrame < GAME_OVER_BLINKS)
+        {
+            moveCursorTo(centerRow, centerCol);
+            if (blinkFrame % 2 == 0)
+                cout << "\033[5;31m=== GAME OVER ===\033[0m";
+            cout.flush();
+            return;
+        }
 
-    moveCursorTo(centerRow - 2, centerCol);
-    cout << "\033[5;31m=== GAME OVER ===\033[0m";
+        moveCursorTo(centerRow - 2, centerCol);
+        cout << "\033[5;31m=== GAME OVER ===\033[0m";
 
-    moveCursorTo(centerRow, centerCol);
-    cout << "Your final score: " << score;
+        moveCursorTo(centerRow, centerCol);
+        cout << "Your final score: " << currentScore();
 
-    moveCursorTo(centerRow + 2, centerCol);
-    cout << "1. Restart";
+        moveCursorTo(centerRow + 2, centerCol);
+        cout << "1. Restart";
 
-    moveCursorTo(centerRow + 3, centerCol);
-    cout << "2. Exit Game";
+        moveCursorTo(centerRow + 3, centerCol);
+        cout << "2. Exit Game";
 
-    cout.flush();
+        if (countdown > 0)
+        {
+            moveCursorTo(centerRow + 5, centerCol);
+            cout << "\033[33mRestarting in " << countdown << "...\033[0m ";
+        }
+        cout.flush();
+    };
 
-    while (true)
+    draw();
+    for (int i = 1; i <= GAME_OVER_BLINKS; ++i)
     {
-        char ch = getInput();
-        if (ch == '1')
+        timeline.after(i * GAME_OVER_BLINK_PERIOD, [&, i]()
         {
-            // Countdown animation
-            for (int i = 3; i >= 1; --i)
-            {
-                moveCursorTo(centerRow + 5, centerCol);
-                cout << "\033[33mRestarting in " << i << "...\033[0m ";
-                cout.flush();
-                usleep(1000000);
-            }
+            blinkFrame = i;
+            draw();
+        });
+    }
 
-            run = true;
-            score = 0;
-            dir = Direction::RIGHT;
-            foodPositions.clear();
-            head = tail = snakeSize = 0;
-            snakeBody.clear();
-            clearTerminal();
-            return true; // Restart
+    while (true)
+    {
+        char ch = waitForKey();
+        if (ch == KEY_RESIZE)
+        {
+            getTerminalSize(rows, cols);
+            draw();
+        }
+        else if (ch == '1')
+        {
+            break;
         }
         else if (ch == '2')
         {
+            timeline.clear();
             return false; // Exit
         }
-        usleep(10000);
     }
+
+    // Countdown animation; keys pressed meanwhile are left for the new game
+    timeline.clear();
+    blinkFrame = GAME_OVER_BLINKS;
+    countdown = RESTART_COUNTDOWN;
+    draw();
+    auto restartAt = GameClock::now() + chrono::seconds(RESTART_COUNTDOWN);
+    for (int i = 1; i < RESTART_COUNTDOWN; ++i)
+    {
+        timeline.at(restartAt - chrono::seconds(RESTART_COUNTDOWN - i), [&]()
+        {
+            countdown--;
+            draw();
+        });
+    }
+    while (waitForEvent(restartAt, false).key == KEY_RESIZE)
+    {
+        getTerminalSize(rows, cols);
+        draw();
+    }
+
+    run = true;
+    dir = Direction::RIGHT;
+    turns.clear();
+    clearTerminal();
+    return true; // Restart
 }
 
-void createFood(int top, int left)
+void createFood(size_t firstNew)
 {
-    int toSpawn = foodCount - static_cast<int>(foodPositions.size());
-    int attempts = 0;
+    const vector<pair<int, int>> &food = infiniteBoard ? world.foodPositions : game.foodPositions;
+    for (size_t i = firstNew; i < food.size(); ++i)
+        putCell(food[i], '@', STYLE_FOOD);
 
-    while (toSpawn > 0 && attempts < MAX_ATTEMPTS)
-    {
-        int fx = left + 1 + rand() % (borderWidth - 2);
-        int fy = top + 1 + rand() % (borderHeight - 2);
-        pair<int, int> food = {fy, fx};
+    if (infiniteBoard ? world.foodShortfall : game.foodShortfall)
+        screen.text(camera.screenTop + camera.viewRows + 2, camera.screenLeft - 1,
+                    "[!] Warning: Could not place all food. Board may be too full.", STYLE_WARNING);
+}
 
-        if (snakeBody.find(food) == snakeBody.end() &&
-            find(foodPositions.begin(), foodPositions.end(), food) == foodPositions.end())
+// Repaints the camera's window from the engine's occupancy grid. Costs the
+// window's area whatever the size of the board or the length of the snake.
+void drawBoard()
+{
+    for (int row = camera.originRow; row < camera.originRow + camera.viewRows; ++row)
+    {
+        for (int col = camera.originCol; col < camera.originCol + camera.viewCols; ++col)
         {
-            foodPositions.push_back(food);
-            moveCursorTo(fy, fx);
-            cout << foodColor << "@" << "\033[0m";
-            toSpawn--;
+            Cell cell = infiniteBoard ? world.cellAt(row, col) : game.cellAt(row, col);
+            if (cell == Cell::SNAKE)
+                putCell({row, col}, 'S', STYLE_SNAKE);
+            else if (cell == Cell::FOOD)
+                putCell({row, col}, '@', STYLE_FOOD);
+            else
+                putCell({row, col}, ' ', STYLE_DEFAULT);
         }
-
-        attempts++;
     }
+}
 
-    if (toSpawn > 0)
-    {
-        moveCursorTo(top + borderHeight + 2, left);
-        cout << "\033[31m[!] Warning: Could not place all food. Board may be too full.\033[0m";
-    }
+// Starts the framebuffer over at the terminal's current size, for a
+// terminal that has just been cleared. Viewers still show the old screen,
+// so they get a keyframe with the next frame instead of a diff.
+void resetScreen()
+{
+    getTerminalSize(rows, cols);
+    screen.resize(rows, cols);
+    spectators.requestKeyframes();
+}
 
-    cout.flush();
+// Fits the camera's window to the terminal and keeps the head in view.
+void layoutCamera()
+{
+    if (infiniteBoard)
+        camera.layout(0, 0, rows, cols);
+    else
+        camera.layout(game.width, game.height, rows, cols);
+    camera.follow(infiniteBoard ? world.get_front() : game.get_front());
 }
 
-void drawSnake()
+// Lays the screen out again for a resized terminal without restarting the
+// game. A terminal that grew keeps what it showed, so present() only sends
+// the cells that moved and the newly exposed ones. One that lost rows may
+// have scrolled its contents, and one that lost columns may have reflowed
+// its wrapped lines, so either is cleared and painted afresh.
+void relayout()
 {
-    for (int i = 0; i < snakeSize; ++i)
+    int oldRows = rows, oldCols = cols;
+    getTerminalSize(rows, cols);
+    if (rows == oldRows && cols == oldCols)
+        return;
+
+    if (rows < oldRows || cols < oldCols)
     {
-        auto pos = snakeBuffer[mod(head + i)];
-        moveCursorTo(pos.first, pos.second);
-        cout << snakeColor << "S" << "\033[0m";
+        clearTerminal();
+        resetScreen();
     }
-    cout.flush();
+    else
+    {
+        screen.reshape(rows, cols);
+    }
+
+    layoutCamera();
+    drawBorders();
+    drawBoard();
+    drawSidebar();
+    createFood(0);
 }
 
-Direction charToDirection(char ch)
+char directionToChar(Direction d)
 {
-    switch (ch)
+    switch (d)
     {
-    case 'w':
-        return Direction::UP;
-    case 's':
-        return Direction::DOWN;
-    case 'a':
-        return Direction::LEFT;
-    case 'd':
-        return Direction::RIGHT;
+    case Direction::UP:
+        return 'w';
+    case Direction::DOWN:
+        return 's';
+    case Direction::LEFT:
+        return 'a';
+    case Direction::RIGHT:
     default:
-        return dir;
+        return 'd';
     }
 }
 
-int getRawNumberInput(int min, int max)
+// Reads a number between min and max typed after `prompt`. Draws the
+// prompt itself so a resize can put it back in the middle of the screen.
+int getRawNumberInput(const char *prompt, int min, int max)
 {
     string input;
-    char ch;
+    bool invalid = false;
+    auto draw = [&]()
+    {
+        clearTerminal();
+        moveCursorTo(rows / 2, cols / 2 - 20);
+        cout << prompt;
+        if (invalid)
+        {
+            moveCursorTo(rows / 2 + 1, cols / 2 - 20);
+            cout << "Invalid range. Try again: ";
+        }
+        cout << input;
+        cout.flush();
+    };
+
+    draw();
     while (true)
     {
-        ch = getInput();
-        if (ch >= '0' && ch <= '9')
+        char ch = waitForKey();
+        if (ch == KEY_RESIZE)
+        {
+            getTerminalSize(rows, cols);
+            draw();
+        }
+        else if (ch >= '0' && ch <= '9')
         {
             input += ch;
             cout << ch;
@@ -338,8 +802,8 @@ int getRawNumberInput(int min, int max)
                 else
                 {
                     input.clear();
-                    cout << "\nInvalid range. Try again: ";
-                    cout.flush();
+                    invalid = true;
+                    draw();
                 }
             }
         }
@@ -352,56 +816,65 @@ int getRawNumberInput(int min, int max)
                 cout.flush();
             }
         }
-        usleep(10000); // allow time to process key
     }
 }
 
-void changeSnakeSpeed()
+// Shows `prompt` and waits for one of `choices`.
+char getChoice(const char *prompt, const string &choices)
 {
-    clearTerminal();
-    moveCursorTo(rows / 2, cols / 2 - 20);
-    cout << "Choose your speed level (1-4, 1 = slowest, 4 = fastest)): ";
-    cout.flush();
-    bool correctInput = false;
+    auto draw = [&]()
+    {
+        clearTerminal();
+        moveCursorTo(rows / 2, cols / 2 - 20);
+        cout << prompt;
+        cout.flush();
+    };
 
-    while (correctInput == false)
+    draw();
+    while (true)
     {
-        int value = getRawNumberInput(1, 4);
-        usleep(10000);
-        switch (value)
+        char ch = waitForKey();
+        if (ch == KEY_RESIZE)
         {
-        case 1:
-            snakeSpeed = 500000;
-            correctInput = true;
-            break;
-        case 2:
-            snakeSpeed = 250000;
-            correctInput = true;
-            break;
-        case 3:
-            snakeSpeed = 100000;
-            correctInput = true;
-            break;
-        case 4:
-            snakeSpeed = 50000;
-            correctInput = true;
-            break;
-        default:
-            cout << "Wrong Input! Try again!";
-            break;
+            getTerminalSize(rows, cols);
+            draw();
+        }
+        else if (choices.find(ch) != string::npos)
+        {
+            return ch;
         }
     }
+}
 
-    moveCursorTo(rows / 2 + 1, cols / 2 - 10);
-    cout << "Speed updated to " << snakeSpeed << " ms!";
-    cout.flush();
-    usleep(500000);
-    clearTerminal();
+void changeSnakeSpeed()
+{
+    switch (getRawNumberInput("Choose your speed level (1-4, 1 = slowest, 4 = fastest)): ", 1, 4))
+    {
+    case 1:
+        snakeSpeed = 500000;
+        break;
+    case 2:
+        snakeSpeed = 250000;
+        break;
+    case 3:
+        snakeSpeed = 100000;
+        break;
+    case 4:
+    default:
+        snakeSpeed = 50000;
+        break;
+    }
+
+    recording.events.push_back({gameTicks, 'V', static_cast<uint64_t>(snakeSpeed)});
 }
 
+// Drawn once and again only after a choice or a resize. Confirmations show
+// under the menu until a timeline entry takes them down, instead of
+// holding the menu up for half a second.
 void settingsMenu()
 {
-    while (true)
+    string notice;
+    auto draw = [&]()
     {
         clearTerminal();
         moveCursorTo(rows / 2 - 2, cols / 2 - 10);
@@ -416,131 +889,123 @@ void settingsMenu()
         cout << "4. Food Amount (current: " << foodCount << ")";
         moveCursorTo(rows / 2 + 3, cols / 2 - 10);
         cout << "5. Back to Pause Menu";
+        if (!notice.empty())
+        {
+            moveCursorTo(rows / 2 + 5, cols / 2 - 10);
+            cout << notice;
+        }
         cout.flush();
+    };
+    auto showNotice = [&](string text)
+    {
+        notice = std::move(text);
+        draw();
+        timeline.clear();
+        timeline.after(NOTICE_DURATION, [&]()
+        {
+            notice.clear();
+            draw();
+        });
+    };
 
-        char ch = getInput();
+    draw();
+    while (true)
+    {
+        char ch = waitForKey();
 
-        if (ch == '\033') // ESC key
-            return;
+        if (ch == '\033' || ch == '5') // ESC key
+            break;
 
-        if (ch == '1')
+        if (ch == KEY_RESIZE)
+        {
+            getTerminalSize(rows, cols);
+            draw();
+        }
+        else if (ch == '1')
         {
             changeSnakeSpeed();
+            showNotice("Speed updated to " + to_string(snakeSpeed) + " ms!");
         }
         else if (ch == '2')
         {
-            clearTerminal();
-            char c = '\0';
-            do
-            {
-                moveCursorTo(rows / 2, cols / 2 - 20);
-                cout << "Choose Snake Color: 1=Green 2=Yellow 3=Cyan: ";
-                cout.flush();
-                c = getInput();
-                usleep(10000);
-            } while (c != '1' && c != '2' && c != '3');
-
+            char c = getChoice("Choose Snake Color: 1=Green 2=Yellow 3=Cyan: ", "123");
             if (c == '1')
                 snakeColor = "\033[32m";
             else if (c == '2')
                 snakeColor = "\033[33m";
             else if (c == '3')
                 snakeColor = "\033[36m";
-
-            moveCursorTo(rows / 2 + 1, cols / 2 - 10);
-            cout << "Color changed!";
-            cout.flush();
-            usleep(500000);
-            clearTerminal();
+            showNotice("Color changed!");
         }
         else if (ch == '3')
         {
-            clearTerminal();
-            char c = '\0';
-            do
-            {
-                moveCursorTo(rows / 2, cols / 2 - 20);
-                cout << "Choose Food Color: 1=Red 2=Magenta 3=Blue: ";
-                cout.flush();
-                c = getInput();
-                usleep(10000);
-            } while (c != '1' && c != '2' && c != '3');
-
+            char c = getChoice("Choose Food Color: 1=Red 2=Magenta 3=Blue: ", "123");
             if (c == '1')
                 foodColor = "\033[31m";
             else if (c == '2')
                 foodColor = "\033[35m";
             else if (c == '3')
                 foodColor = "\033[34m";
-
-            moveCursorTo(rows / 2 + 1, cols / 2 - 10);
-            cout << "Color changed!";
-            cout.flush();
-            usleep(500000);
-            clearTerminal();
+            showNotice("Color changed!");
         }
         else if (ch == '4')
         {
-            clearTerminal();
-            char c = '\0';
-            do
-            {
-                moveCursorTo(rows / 2, cols / 2 - 20);
-                cout << "Enter food amount (1-3): ";
-                cout.flush();
-                c = getInput();
-                usleep(10000);
-            } while (c != '1' && c != '2' && c != '3');
-            foodCount = c - '0';
-
-            moveCursorTo(rows / 2 + 1, cols / 2 - 10);
-            cout << "Food count updated!";
-            cout.flush();
-            usleep(500000);
-            clearTerminal();
+            foodCount = getChoice("Enter food amount (1-3): ", "123") - '0';
+            game.foodCount = foodCount;
+            world.foodCount = foodCount;
+            recording.events.push_back({gameTicks, 'F', static_cast<uint64_t>(foodCount)});
+            showNotice("Food count updated!");
         }
-        else if (ch == '5')
-            break;
-        usleep(200000);
     }
+    timeline.clear(); // the notice entry refers to locals of this function
 }
 
 void pauseMenu()
 {
-    pauseStart = chrono::steady_clock::now();
+    pauseStart = GameClock::now();
+    pausedThisFrame = true;
 
-    clearTerminal();
-    moveCursorTo(rows / 2 - 1, cols / 2 - 10);
-    cout << "=== GAME PAUSED ===";
-    moveCursorTo(rows / 2, cols / 2 - 10);
-    cout << "1. Continue";
-    moveCursorTo(rows / 2 + 1, cols / 2 - 10);
-    cout << "2. Settings";
-    moveCursorTo(rows / 2 + 2, cols / 2 - 10);
-    cout << "3. Exit";
-    cout.flush();
+    auto draw = []()
+    {
+        clearTerminal();
+        moveCursorTo(rows / 2 - 1, cols / 2 - 10);
+        cout << "=== GAME PAUSED ===";
+        moveCursorTo(rows / 2, cols / 2 - 10);
+        cout << "1. Continue";
+        moveCursorTo(rows / 2 + 1, cols / 2 - 10);
+        cout << "2. Settings";
+        moveCursorTo(rows / 2 + 2, cols / 2 - 10);
+        cout << "3. Exit";
+        cout.flush();
+    };
 
+    draw();
     while (true)
     {
-        char ch = getInput();
-        if (ch == '1' || ch == '\033')
+        char ch = waitForKey();
+        if (ch == KEY_RESIZE)
         {
-            totalPausedTime += chrono::steady_clock::now() - pauseStart;
+            getTerminalSize(rows, cols);
+            draw();
+        }
+        else if (ch == '1' || ch == '\033')
+        {
+            totalPausedTime += GameClock::now() - pauseStart;
+            tickClock.resync(chrono::microseconds(snakeSpeed));
             clearTerminal();
-            drawBorders((rows - borderHeight) / 2, (cols - borderWidth) / 2);
-            drawSnake();
-            for (const auto &food : foodPositions)
-            {
-                moveCursorTo(food.first, food.second);
-                cout << foodColor << "@" << "\033[0m";
-            }
-            cout.flush();
+            resetScreen(); // the terminal may have been resized meanwhile
+            applyColors();
+            layoutCamera();
+            drawBorders();
+            drawBoard();
+            drawSidebar();
+            presentFrame();
             break;
         }
         else if (ch == '2')
         {
             settingsMenu();
-            return pauseMenu();
+            draw();
         }
         else if (ch == '3')
         {
@@ -548,11 +1013,10 @@ void pauseMenu()
             playerLost = false;
             break;
         }
-        usleep(10000);
     }
 }
 
-void handleInput(char ch)
+void handleInput(char ch, GameClock::time_point readAt)
 {
     if (ch == '\033')
     {
@@ -560,90 +1024,116 @@ void handleInput(char ch)
         return;
     }
 
-    Direction newDir = charToDirection(ch);
-    switch (newDir)
-    {
-    case Direction::UP:
-        if (dir != Direction::DOWN)
-            dir = Direction::UP;
-        break;
-    case Direction::DOWN:
-        if (dir != Direction::UP)
-            dir = Direction::DOWN;
-        break;
-    case Direction::LEFT:
-        if (dir != Direction::RIGHT)
-            dir = Direction::LEFT;
-        break;
-    case Direction::RIGHT:
-        if (dir != Direction::LEFT)
-            dir = Direction::RIGHT;
-        break;
-    }
+    // Turns wait in the queue and GameCore applies one per tick; q ends
+    // the game. A replay brings its own turns, so the keyboard only steers
+    // live games.
+    if (playingBack && isTurnKey(ch))
+        return;
+    if (core.key(ch, readAt))
+        return;
 
-    if (ch == 'q')
-        run = false;
-}
+    if (ch == 'p')
+        profiler.showPanel = !profiler.showPanel;
 
-void updateSnake(int top, int left)
-{
-    int dx = 0, dy = 0;
-    switch (dir)
+    // Both steer by searching a dense grid, which an unbounded board lacks
+    if (ch == 'o' && !infiniteBoard)
     {
-    case Direction::UP:
-        dx = -1;
-        break;
-    case Direction::DOWN:
-        dx = 1;
-        break;
-    case Direction::LEFT:
-        dy = -1;
-        break;
-    case Direction::RIGHT:
-        dy = 1;
-        break;
+        autopilotOn = !autopilotOn;
+        autopilot.reset(game);
     }
 
-    pair<int, int> currentHead = get_front();
-    int newRow = currentHead.first + dx;
-    int newCol = currentHead.second + dy;
-    pair<int, int> newHead = {newRow, newCol};
-
-    if (newRow < top || newRow >= top + borderHeight ||
-        newCol <= left || newCol >= left + borderWidth ||
-        snakeBody.count(newHead))
+    if (ch == 'h' && !infiniteBoard)
     {
-        playerLost = true;
-        run = false;
-        return;
+        solverOn = !solverOn;
+        solverEngaged = false;
+        if (solverOn)
+            solver.reset(game);
+        autopilot.reset(game);
     }
+}
 
-    bool ate = false;
-    for (size_t i = 0; i < foodPositions.size(); ++i)
+// Replays and the bots queue their turns like a player would, once any
+// typed turns are used up. Boards without a Hamiltonian cycle fall back to
+// the autopilot, and so does a snake off the cycle (after H mid-game, a
+// typed turn, or a new game that starts heading against the cycle) until
+// it lies in cycle order. Their turns carry no read time, since nobody
+// typed them.
+void UnixHooks::beforeStep(UnixCore &core)
+{
+    if (playingBack)
     {
-        if (newRow == foodPositions[i].first && newCol == foodPositions[i].second)
+        int speed = snakeSpeed;
+        applyReplayEvents(playback, playbackNext, core.ticks, core.game, core.dir, core.turns, speed);
+        if (speed != snakeSpeed)
         {
-            score++;
-            ate = true;
-            foodPositions.erase(foodPositions.begin() + i); // Remove eaten food
-            break;
+            snakeSpeed = speed;
+            tickClock.period = chrono::microseconds(snakeSpeed);
         }
+        return;
     }
 
-    push_front(newHead);
+    if (core.turns.count != 0)
+        return;
+    if (solverOn && !solverEngaged)
+        solverEngaged = solver.inCycleOrder(core.game, core.dir);
+    if (solverEngaged)
+        core.key(directionToChar(solver.choose(core.game, core.dir)));
+    else if (autopilotOn || solverOn)
+        core.key(directionToChar(autopilot.choose(core.game, core.dir)));
+}
+
+// Every turn is recorded on the tick it is applied, which is when a
+// replay queues it again. Only keypresses are latency samples, not bot or
+// replayed turns.
+void UnixHooks::turned(UnixCore &core, GameClock::time_point pressed)
+{
+    if (!playingBack)
+        recording.events.push_back({core.ticks, directionToChar(core.dir), 0});
+    if (pressed == GameClock::time_point())
+        return;
+    solverEngaged = false;
+    if (latency.enabled)
+        latency.applied(pressed, GameClock::now());
+}
 
-    if (ate)
+StepResult UnixHooks::step(UnixCore &core)
+{
+    return infiniteBoard ? world.step(core.dir) : core.game.step(core.dir);
+}
+
+// Draws the tick itself when it scrolled or ate; GameCore draws the rest.
+bool UnixHooks::afterStep(UnixCore &core, const StepResult &result)
+{
+    if (autopilotOn || solverOn)
+        autopilot.update(core.game, result);
+
+    if (playingBack && core.ticks >= playback.ticks)
+        core.running = false;
+
+    if (result.outcome == StepOutcome::DIED)
     {
-        createFood(top, left);
+        playerLost = true;
+        return true;
     }
-    else
+
+    // Scrolling repaints the window from the grid, which already has this
+    // tick's changes; so does food the unbounded world moved.
+    if (camera.follow(result.newHead) || (infiniteBoard && world.foodMoved))
     {
-        moveCursorTo(get_back().first, get_back().second);
-        cout << " ";
-        pop_back();
+        drawBorders();
+        drawBoard();
+        return true;
     }
 
-    drawSnake();
+    // New food comes from whichever board is in play, with a warning if it
+    // ran out of room
+    if (result.outcome == StepOutcome::ATE)
+    {
+        createFood(result.firstNewFood);
+        putCell(result.newHead, 'S', STYLE_SNAKE);
+        return true;
+    }
+    return false;
 }
 
 void initializeTerminal()
@@ -652,54 +1142,313 @@ void initializeTerminal()
     enableRawMode();
     setNonBlockingInput();
     hideCursor();
+    frameOutput.synchronized = detectSynchronizedOutput();
+    startInputThread();
+    watchWindowSize();
     getTerminalSize(rows, cols);
 }
 
-void initializeGame(int &top, int &left)
+void initializeGame()
 {
-    getTerminalSize(rows, cols);
-    top = (rows - borderHeight) / 2;
-    left = (cols - borderWidth) / 2;
+    resetScreen();
+    applyColors();
 
-    drawBorders(top, left);
+    uint64_t seed = static_cast<uint64_t>(time(0));
+    if (playingBack)
+    {
+        seed = playback.seed;
+        foodCount = playback.foodCount;
+        snakeSpeed = playback.speedUs;
+        playbackNext = 0;
+    }
+    if (infiniteBoard)
+    {
+        world.reset(foodCount, seed);
+    }
+    else
+    {
+        game.reset(borderWidth - 1, borderHeight, foodCount, seed);
+        autopilot.reset(game);
+        solverEngaged = false;
+        if (solverOn)
+            solver.reset(game);
+    }
+    layoutCamera();
+    camera.centreOn(infiniteBoard ? world.get_front() : game.get_front());
+
+    recording = Replay();
+    recording.seed = seed;
+    recording.width = game.width;
+    recording.height = game.height;
+    recording.foodCount = foodCount;
+    recording.speedUs = snakeSpeed;
+    gameTicks = 0;
+
+    drawBorders();
+    drawBoard();
+    createFood(0);
+    presentFrame();
+
+    core.clock.start();
+}
 
-    int midRow = rows / 2;
-    int midCol = cols / 2;
-    pair<int, int> start = {midRow, midCol};
+void UnixTerminal::clear(const GameState &)
+{
+    clearTerminal();
+    resetScreen();
+    drawBorders();
+}
+
+void UnixTerminal::cell(pair<int, int> pos, Cell what)
+{
+    if (what == Cell::SNAKE)
+        putCell(pos, 'S', STYLE_SNAKE);
+    else if (what == Cell::FOOD)
+        putCell(pos, '@', STYLE_FOOD);
+    else
+        putCell(pos, ' ', STYLE_DEFAULT);
+}
 
-    push_front(start);
-    moveCursorTo(midRow, midCol);
-    cout << "S" << endl;
+void UnixTerminal::present(const GameState &)
+{
+    drawSidebar();
+    presentFrame();
+}
+
+void UnixClock::start()
+{
+    tickClock.resync(chrono::microseconds(snakeSpeed));
+    gameStart = tickClock.lastTick;
+    ticksDue = 1;
+}
 
-    srand(static_cast<unsigned int>(time(0)));
-    createFood(top, left);
+void UnixClock::wait()
+{
+    waitForNextTick();
+    ticksDue = tickClock.advance();
+}
 
-    gameStart = chrono::steady_clock::now();
+// Every key goes through handleInput(), which hands the game's own keys to
+// GameCore::key() with the time they were read and opens menus for the
+// rest straight away, before the tick.
+template <typename F>
+void UnixInput::poll(F &&)
+{
+    for (KeyEvent event = nextKey(); event.key; event = nextKey())
+        handleInput(event.key, event.readAt);
 }
 
-void gameLoop(int top, int left)
+void gameLoop()
 {
     while (run)
     {
-        char ch = getInput();
-        if (ch)
-            handleInput(ch);
+        auto frameStart = GameClock::now();
+        pausedThisFrame = false;
+
+        for (int i = 0; i < core.clock.ticksDue && run; ++i)
+            core.update();
+        auto simEnd = GameClock::now();
+
+        unsigned long bytesBefore = frameOutput.bytesWritten;
+        unsigned long writesBefore = frameOutput.writeCalls;
+        core.terminal.present(game);
+        auto renderEnd = GameClock::now();
+
+        core.clock.wait();
+
+        // Frames that sat in the pause menu would swamp the averages
+        if (!pausedThisFrame)
+        {
+            FrameSample sample;
+            sample.simNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(simEnd - frameStart).count());
+            sample.renderNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(renderEnd - simEnd).count());
+            sample.bytes = frameOutput.bytesWritten - bytesBefore;
+            sample.writes = frameOutput.writeCalls - writesBefore;
+            sample.sleepNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(GameClock::now() - renderEnd).count());
+            sample.lateNs = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(tickClock.lastLate).count());
+            profiler.record(sample);
+        }
+    }
+}
+
+// Saves the game that just ended if --record was given.
+void finishRecording()
+{
+    recording.ticks = gameTicks;
+    recording.score = game.score;
+    if (!recordPath.empty() && !playingBack)
+        recording.save(recordPath);
+}
+
+// Re-simulates a replay `loops` times without a terminal and checks the
+// final score against the recording. Returns the process exit code.
+int runHeadlessReplay(int loops)
+{
+    GameState replayGame;
+    uint64_t totalTicks = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < loops; ++i)
+        totalTicks += simulateReplay(playback, replayGame);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    bool match = replayGame.score == playback.score;
+    printf("replay: %dx%d board, %llu ticks, score %u (recorded %u) %s\n", playback.width, playback.height,
+           static_cast<unsigned long long>(playback.ticks), replayGame.score, playback.score, match ? "OK" : "MISMATCH");
+    printf("%d run(s), %.3f s, %.0f ticks/s\n", loops, seconds, seconds > 0 ? totalTicks / seconds : 0.0);
+    return match ? 0 : 1;
+}
+
+// Lets the solver play one game on the configured board without a
+// terminal until it fills the board or dies. Returns the process exit code.
+int runHeadlessSolver()
+{
+    GameState solverGame;
+    uint64_t seed = static_cast<uint64_t>(time(0));
+    solverGame.reset(borderWidth - 1, borderHeight, foodCount, seed);
+    if (!solver.build(solverGame.width, solverGame.height))
+    {
+        fprintf(stderr, "A %dx%d board has no Hamiltonian cycle (it needs an even number of cells)\n",
+                solverGame.width, solverGame.height);
+        return 1;
+    }
 
-        updateSnake(top, left);
-        drawSidebar(top, left);
-        usleep(snakeSpeed);
+    Direction heading = solver.onward[solverGame.snake.front()];
+    TurnQueue solverTurns;
+    uint64_t ticks = 0;
+    size_t area = static_cast<size_t>(solverGame.width) * solverGame.height;
+    auto start = chrono::steady_clock::now();
+    while (solverGame.alive && solverGame.length() < area)
+    {
+        solverTurns.push(heading, solver.choose(solverGame, heading));
+        solverTurns.pop(heading);
+        solverGame.step(heading);
+        ticks++;
     }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    bool filled = solverGame.length() == area;
+    printf("solver: %dx%d board, seed %llu, %llu ticks, length %zu/%zu %s\n", solverGame.width, solverGame.height,
+           static_cast<unsigned long long>(seed), static_cast<unsigned long long>(ticks), solverGame.length(), area,
+           filled ? "FILLED" : "DIED");
+    printf("%.3f s, %.0f ticks/s\n", seconds, seconds > 0 ? ticks / seconds : 0.0);
+    return filled ? 0 : 1;
+}
+
+// Whether GameState can hold a width x height board: the engine must be
+// able to index it and its dense grids must fit in half of physical
+// memory, leaving the rest for the autopilot's and solver's own grids.
+// Larger boards would only fail inside vector::assign or thrash.
+bool boardFits(long long width, long long height, uint64_t &bytes)
+{
+    if (!validBoardSize(static_cast<uint64_t>(max(width, 0LL)), static_cast<uint64_t>(max(height, 0LL))))
+        return false;
+    bytes = static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * BOARD_BYTES_PER_CELL;
+    long pages = sysconf(_SC_PHYS_PAGES), pageSize = sysconf(_SC_PAGE_SIZE);
+    return pages <= 0 || pageSize <= 0 || bytes <= static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) / 2;
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+    bool headless = false;
+    int loops = 1;
+    long long boardWidth = DEFAULT_BORDER_WIDTH - 1, boardHeight = DEFAULT_BORDER_HEIGHT;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--latency")
+            latency.enabled = true;
+        else if (arg == "--profile-csv" && i + 1 < argc)
+            profiler.csvPath = argv[++i];
+        else if (arg == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            if (!playback.load(argv[++i]))
+            {
+                fprintf(stderr, "Could not read replay %s: missing, truncated or corrupt\n", argv[i]);
+                return 1;
+            }
+            playingBack = true;
+        }
+        else if (arg == "--autopilot")
+            autopilotOn = true;
+        else if (arg == "--solver")
+            solverOn = true;
+        else if (arg == "--width" && i + 1 < argc)
+            boardWidth = max(2LL, strtoll(argv[++i], nullptr, 10));
+        else if (arg == "--height" && i + 1 < argc)
+            boardHeight = max(2LL, strtoll(argv[++i], nullptr, 10));
+        else if (arg == "--infinite")
+            infiniteBoard = true;
+        else if (arg == "--spectate" && i + 1 < argc)
+        {
+            if (!spectators.listen(argv[++i]))
+            {
+                fprintf(stderr, "Could not listen on %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "--theme" && i + 1 < argc)
+        {
+            string name = argv[++i];
+            auto found = find_if(begin(themes), end(themes), [&](const Theme &t) { return name == t.name; });
+            if (found == end(themes))
+            {
+                fprintf(stderr, "Unknown theme %s (basic, 256 or truecolor)\n", name.c_str());
+                return 1;
+            }
+            theme = found;
+            snakeColor = theme->snake;
+            foodColor = theme->food;
+        }
+        else if (arg == "--headless")
+            headless = true;
+        else if (arg == "--loops" && i + 1 < argc)
+            loops = max(1, atoi(argv[++i]));
+    }
+
+    if (infiniteBoard && (playingBack || !recordPath.empty() || autopilotOn || solverOn || headless))
+    {
+        fprintf(stderr, "--infinite cannot be combined with --replay, --record, --autopilot, --solver or --headless\n");
+        return 1;
+    }
+
+    // A replay brings its own board
+    if (playingBack)
+    {
+        boardWidth = playback.width;
+        boardHeight = playback.height;
+    }
+    uint64_t boardBytes = 0;
+    if (!infiniteBoard && !boardFits(boardWidth, boardHeight, boardBytes))
+    {
+        if (boardBytes)
+            fprintf(stderr, "A %lldx%lld board needs %.1f GB, more than this machine can spare; try --infinite\n",
+                    boardWidth, boardHeight, static_cast<double>(boardBytes) / 1e9);
+        else
+            fprintf(stderr, "A %lldx%lld board has too many cells; try --infinite\n", boardWidth, boardHeight);
+        return 1;
+    }
+    borderWidth = static_cast<int>(boardWidth) + 1;
+    borderHeight = static_cast<int>(boardHeight);
+
+    if (headless)
+    {
+        if (playingBack)
+            return runHeadlessReplay(loops);
+        if (solverOn)
+            return runHeadlessSolver();
+        fprintf(stderr, "--headless needs --replay FILE or --solver\n");
+        return 1;
+    }
+
     initializeTerminal();
 
     while (true)
     {
-        int top, left;
-        initializeGame(top, left);
-        gameLoop(top, left);
+        initializeGame();
+        gameLoop();
+        finishRecording();
 
         if (playerLost)
         {
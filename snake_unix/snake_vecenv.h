@@ -0,0 +1,227 @@
+#pragma once
+
+// Batched environments for reinforcement learning.
+//
+// VectorEnv steps thousands of independent boards in lock-step with one
+// call to step_batch(). The per-env state the movement rules touch every
+// tick (head row/col, direction, length, food cell) is stored
+// struct-of-arrays, so the turn, head-move, wall-check and food-check pass
+// is a straight loop over small integer arrays that the compiler
+// vectorizes. Self-collision and the snake bodies
+// live in a second, per-env pass: a 1-bit-per-cell occupancy bitmap and a
+// ring of cell indices for each env.
+//
+// Rules match the game: an action that reverses the env's direction is
+// ignored and the snake keeps going, as TurnQueue does for a key, and then
+// GameState::step() applies. Moving into a wall or any body cell
+// (including the tail that is about to move) ends the episode, eating
+// grows the snake by one and respawns the food. Each env has one food
+// item. Finished envs are reset in place, heading RIGHT, and report
+// done = 1.
+
+#include <cstdint>
+#include <vector>
+
+#include "snake_engine.h"
+
+// Actions use Direction's order: 0 = UP, 1 = DOWN, 2 = LEFT, 3 = RIGHT.
+constexpr float REWARD_FOOD = 1.0f;
+constexpr float REWARD_DEATH = -1.0f;
+
+struct VectorEnv
+{
+    int numEnvs = 0;
+    int width = 0, height = 0;
+    uint32_t area = 0;
+    uint32_t wordsPerEnv = 0;
+    uint32_t maxEpisodeTicks = 0; // truncate episodes that never end, 0 = no limit
+
+    // Hot per-env state, struct-of-arrays
+    std::vector<int32_t> headRow, headCol;
+    std::vector<uint8_t> dir; // Direction the snake is moving in
+    std::vector<int32_t> length;
+    std::vector<int32_t> food;          // food cell index
+    std::vector<uint32_t> episodeTicks;
+    std::vector<uint32_t> score;
+
+    // Per-env bodies: env e owns body[e * area .. (e + 1) * area) as a ring
+    // whose front is ringHead[e], plus wordsPerEnv words of occupancy bits.
+    std::vector<uint32_t> body;
+    std::vector<uint32_t> ringHead;
+    std::vector<uint64_t> occupancy;
+    std::vector<Rng> rng;
+
+    // Scratch filled by the vector pass and consumed by the per-env pass
+    std::vector<int32_t> nextCell;
+    std::vector<uint8_t> hitWall, ate;
+
+    void init(int envs, int boardWidth, int boardHeight, uint64_t seed)
+    {
+        numEnvs = envs;
+        width = boardWidth;
+        height = boardHeight;
+        area = static_cast<uint32_t>(width) * height;
+        wordsPerEnv = (area + 63) / 64;
+
+        size_t n = static_cast<size_t>(envs);
+        headRow.assign(n, 0);
+        headCol.assign(n, 0);
+        dir.assign(n, 0);
+        length.assign(n, 0);
+        food.assign(n, 0);
+        episodeTicks.assign(n, 0);
+        score.assign(n, 0);
+        body.assign(n * area, 0);
+        ringHead.assign(n, 0);
+        occupancy.assign(n * wordsPerEnv, 0);
+        rng.assign(n, Rng());
+        nextCell.assign(n, 0);
+        hitWall.assign(n, 0);
+        ate.assign(n, 0);
+
+        for (int e = 0; e < envs; ++e)
+        {
+            rng[static_cast<size_t>(e)].seed(seed + static_cast<uint64_t>(e));
+            reset(e);
+        }
+    }
+
+    uint64_t *bitsOf(int e) { return &occupancy[static_cast<size_t>(e) * wordsPerEnv]; }
+    uint32_t *bodyOf(int e) { return &body[static_cast<size_t>(e) * area]; }
+
+    bool occupied(int e, uint32_t cell) { return (bitsOf(e)[cell >> 6] >> (cell & 63)) & 1; }
+
+    // Uniformly random free cell, by rejection first and a scan from a
+    // random start once the board is too full for that to be quick.
+    void spawnFood(int e)
+    {
+        Rng &r = rng[static_cast<size_t>(e)];
+        uint32_t free = area - static_cast<uint32_t>(length[static_cast<size_t>(e)]);
+        if (free == 0)
+        {
+            food[static_cast<size_t>(e)] = -1;
+            return;
+        }
+
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            uint32_t cell = r.below(area);
+            if (!occupied(e, cell))
+            {
+                food[static_cast<size_t>(e)] = static_cast<int32_t>(cell);
+                return;
+            }
+        }
+
+        uint32_t skip = r.below(free);
+        for (uint32_t cell = 0; cell < area; ++cell)
+        {
+            if (!occupied(e, cell) && skip-- == 0)
+            {
+                food[static_cast<size_t>(e)] = static_cast<int32_t>(cell);
+                return;
+            }
+        }
+    }
+
+    void reset(int e)
+    {
+        size_t i = static_cast<size_t>(e);
+        uint64_t *bits = bitsOf(e);
+        for (uint32_t w = 0; w < wordsPerEnv; ++w)
+            bits[w] = 0;
+
+        headRow[i] = height / 2;
+        headCol[i] = width / 2;
+        dir[i] = static_cast<uint8_t>(Direction::RIGHT);
+        length[i] = 1;
+        episodeTicks[i] = 0;
+        score[i] = 0;
+
+        uint32_t start = static_cast<uint32_t>(headRow[i]) * width + static_cast<uint32_t>(headCol[i]);
+        ringHead[i] = 0;
+        bodyOf(e)[0] = start;
+        bits[start >> 6] |= 1ull << (start & 63);
+        spawnFood(e);
+    }
+
+    // Advances every env by one tick. actions[e] is a Direction index;
+    // rewards and dones receive one entry per env.
+    void step_batch(const uint8_t *actions, float *rewards, uint8_t *dones)
+    {
+        const int n = numEnvs;
+        const int32_t w = width, h = height;
+        int32_t *__restrict rowOut = headRow.data();
+        int32_t *__restrict colOut = headCol.data();
+        uint8_t *__restrict dirOut = dir.data();
+        int32_t *__restrict cellOut = nextCell.data();
+        uint8_t *__restrict wallOut = hitWall.data();
+        uint8_t *__restrict ateOut = ate.data();
+        const int32_t *__restrict foodIn = food.data();
+
+        // Vector pass: move heads, check walls and food for all envs
+        for (int e = 0; e < n; ++e)
+        {
+            // Directions pair up as UP/DOWN and LEFT/RIGHT, so a reversal
+            // differs from the current direction in the low bit only
+            int32_t current = dirOut[e];
+            int32_t a = actions[e];
+            a = (a ^ 1) == current ? current : a;
+            dirOut[e] = static_cast<uint8_t>(a);
+            int32_t row = rowOut[e] + (a == 1) - (a == 0);
+            int32_t col = colOut[e] + (a == 3) - (a == 2);
+            int32_t wall = (row < 0) | (row >= h) | (col < 0) | (col >= w);
+            int32_t cell = row * w + col;
+            rowOut[e] = row;
+            colOut[e] = col;
+            cellOut[e] = cell;
+            wallOut[e] = static_cast<uint8_t>(wall);
+            ateOut[e] = static_cast<uint8_t>((cell == foodIn[e]) & !wall);
+        }
+
+        // Per-env pass: self-collision, body update, rewards, auto-reset
+        for (int e = 0; e < n; ++e)
+        {
+            size_t i = static_cast<size_t>(e);
+            uint64_t *bits = bitsOf(e);
+            uint32_t cell = static_cast<uint32_t>(cellOut[e]);
+            episodeTicks[i]++;
+
+            if (wallOut[e] || ((bits[cell >> 6] >> (cell & 63)) & 1))
+            {
+                rewards[e] = REWARD_DEATH;
+                dones[e] = 1;
+                reset(e);
+                continue;
+            }
+
+            uint32_t *ring = bodyOf(e);
+            ringHead[i] = ringHead[i] == 0 ? area - 1 : ringHead[i] - 1;
+            ring[ringHead[i]] = cell;
+            bits[cell >> 6] |= 1ull << (cell & 63);
+
+            if (ateOut[e])
+            {
+                length[i]++;
+                score[i]++;
+                rewards[e] = REWARD_FOOD;
+                spawnFood(e);
+            }
+            else
+            {
+                uint32_t tailSlot = (ringHead[i] + static_cast<uint32_t>(length[i])) % area;
+                uint32_t tail = ring[tailSlot];
+                bits[tail >> 6] &= ~(1ull << (tail & 63));
+                rewards[e] = 0.0f;
+            }
+
+            dones[e] = 0;
+            if (static_cast<uint32_t>(length[i]) == area ||
+                (maxEpisodeTicks && episodeTicks[i] >= maxEpisodeTicks))
+            {
+                dones[e] = 1;
+                reset(e);
+            }
+        }
+    }
+};
@@ -0,0 +1,92 @@
+#include <string>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+// Watches a game started with --spectate. The stream already is terminal
+// output, so the viewer only copies it to its own terminal.
+// Build: g++ -O2 snake_viewer.cpp -o snake_viewer
+// Usage: ./snake_viewer [/tmp/snake-spectate.sock]   (Q or Ctrl-C to quit)
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) { stopRequested = 1; }
+
+bool writeAll(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    string path = argc > 1 ? argv[1] : "/tmp/snake-spectate.sock";
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        perror(path.c_str());
+        return 1;
+    }
+
+    struct termios original, raw;
+    bool tty = tcgetattr(STDIN_FILENO, &original) == 0;
+    if (tty)
+    {
+        raw = original;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    writeAll(STDOUT_FILENO, "\033[?25l\033[H\033[J", 12);
+
+    char buf[64 * 1024];
+    struct pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+    while (!stopRequested)
+    {
+        if (poll(fds, 2, -1) < 0)
+            continue; // EINTR, stopRequested is checked above
+
+        if (fds[1].revents & POLLIN)
+        {
+            char key;
+            if (read(STDIN_FILENO, &key, 1) == 1 && (key == 'q' || key == 'Q'))
+                break;
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0 || !writeAll(STDOUT_FILENO, buf, static_cast<size_t>(n)))
+                break; // the game ended
+        }
+    }
+
+    writeAll(STDOUT_FILENO, "\033[0m\033[?25h\033[H\033[J", 16);
+    if (tty)
+        tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    close(fd);
+    return 0;
+}
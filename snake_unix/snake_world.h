@@ -0,0 +1,374 @@
+#pragma once
+
+// Unbounded board for --infinite.
+//
+// A dense grid cannot cover a board without edges, so the world is cut
+// into CHUNK_SIZE x CHUNK_SIZE chunks that only exist while something is
+// in them. Chunks come from a pool and are found through an open-addressing
+// table keyed by the chunk's packed 64-bit coordinates. Each chunk counts
+// its occupied cells and goes back to the pool when the count drops to
+// zero, which is what happens when the tail leaves it.
+//
+// Food is spawned in the chunks around the head and moved once the head
+// has wandered off, so the live chunks are bounded by the snake's length
+// plus the food count, however far the snake has travelled. Coordinates
+// are 32-bit and start at (0, 0); negative rows and columns are fine.
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <cstdlib>
+
+#include "snake_engine.h"
+
+// Constants
+constexpr int CHUNK_SHIFT = 5;
+constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT; // cells along each side of a chunk
+constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+constexpr uint32_t NO_CHUNK = UINT32_MAX;
+constexpr size_t MIN_CHUNK_TABLE = 16;
+constexpr int FOOD_SPAWN_CHUNKS = 1; // food appears at most this many chunks from the head's chunk
+constexpr int FOOD_KEEP_CHUNKS = 2;  // and is moved once the head is further away than this
+constexpr int FOOD_SPAWN_TRIES = 64;
+
+inline uint64_t packCell(int row, int col)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(col);
+}
+
+inline std::pair<int, int> unpackCell(uint64_t packed)
+{
+    return {static_cast<int32_t>(packed >> 32), static_cast<int32_t>(static_cast<uint32_t>(packed))};
+}
+
+struct Chunk
+{
+    uint64_t key = 0;  // packed chunk coordinates
+    uint32_t used = 0; // cells that are not EMPTY
+    Cell cells[CHUNK_SIZE * CHUNK_SIZE];
+};
+
+// Packed chunk coordinates -> pool slot. Linear probing at most half full;
+// erase shifts the rest of the cluster back instead of leaving tombstones,
+// so lookups stay short however many chunks come and go.
+struct ChunkTable
+{
+    struct Slot
+    {
+        uint64_t key;
+        uint32_t id; // NO_CHUNK for an empty slot
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    ChunkTable() { clear(); }
+
+    size_t home(uint64_t key) const
+    {
+        uint64_t h = key * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h ^ (h >> 32)) & (slots.size() - 1);
+    }
+
+    void clear()
+    {
+        slots.assign(MIN_CHUNK_TABLE, Slot{0, NO_CHUNK});
+        count = 0;
+    }
+
+    uint32_t find(uint64_t key) const
+    {
+        for (size_t i = home(key);; i = (i + 1) & (slots.size() - 1))
+        {
+            if (slots[i].id == NO_CHUNK || slots[i].key == key)
+                return slots[i].id;
+        }
+    }
+
+    // `key` must not be in the table yet.
+    void insert(uint64_t key, uint32_t id)
+    {
+        if ((count + 1) * 2 > slots.size())
+            rehash(slots.size() * 2);
+        size_t i = home(key);
+        while (slots[i].id != NO_CHUNK)
+            i = (i + 1) & (slots.size() - 1);
+        slots[i] = {key, id};
+        count++;
+    }
+
+    void erase(uint64_t key)
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = home(key);
+        while (slots[i].key != key || slots[i].id == NO_CHUNK)
+        {
+            if (slots[i].id == NO_CHUNK)
+                return;
+            i = (i + 1) & mask;
+        }
+
+        // Pull back every later entry of the cluster that may sit in the hole
+        for (size_t j = (i + 1) & mask; slots[j].id != NO_CHUNK; j = (j + 1) & mask)
+        {
+            size_t k = home(slots[j].key);
+            bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable)
+            {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].id = NO_CHUNK;
+        count--;
+    }
+
+    void rehash(size_t size)
+    {
+        std::vector<Slot> old(size, Slot{0, NO_CHUNK});
+        old.swap(slots);
+        count = 0;
+        for (const Slot &slot : old)
+        {
+            if (slot.id != NO_CHUNK)
+                insert(slot.key, slot.id);
+        }
+    }
+};
+
+struct ChunkWorld
+{
+    int foodCount = 1;
+    unsigned int score = 0;
+    bool alive = true;
+    bool foodShortfall = false; // last spawn could not place every food item
+    bool foodMoved = false;     // last step moved food the snake had left behind
+    Rng rng;
+
+    std::vector<std::pair<int, int>> foodPositions;
+
+    // Segments as packCell() values, head first
+    BasicRing<uint64_t> snake;
+
+    std::vector<Chunk> pool;
+    std::vector<uint32_t> freeChunks; // pool slots not in use
+    ChunkTable table;
+
+    static uint64_t chunkKey(int row, int col) { return packCell(row >> CHUNK_SHIFT, col >> CHUNK_SHIFT); }
+    static size_t chunkOffset(int row, int col) { return static_cast<size_t>(((row & CHUNK_MASK) << CHUNK_SHIFT) | (col & CHUNK_MASK)); }
+
+    size_t liveChunks() const { return table.count; }
+
+    Cell cellAt(int row, int col) const
+    {
+        uint32_t id = table.find(chunkKey(row, col));
+        return id == NO_CHUNK ? Cell::EMPTY : pool[id].cells[chunkOffset(row, col)];
+    }
+
+    uint32_t allocateChunk(uint64_t key)
+    {
+        uint32_t id;
+        if (!freeChunks.empty())
+        {
+            id = freeChunks.back();
+            freeChunks.pop_back();
+        }
+        else
+        {
+            id = static_cast<uint32_t>(pool.size());
+            pool.emplace_back();
+        }
+
+        Chunk &chunk = pool[id];
+        chunk.key = key;
+        chunk.used = 0;
+        std::fill(std::begin(chunk.cells), std::end(chunk.cells), Cell::EMPTY);
+        table.insert(key, id);
+        return id;
+    }
+
+    // Writes a cell, creating its chunk on the first occupied cell and
+    // returning the chunk to the pool when its last one empties.
+    void set(std::pair<int, int> pos, Cell what)
+    {
+        uint64_t key = chunkKey(pos.first, pos.second);
+        uint32_t id = table.find(key);
+        if (id == NO_CHUNK)
+        {
+            if (what == Cell::EMPTY)
+                return;
+            id = allocateChunk(key);
+        }
+
+        Chunk &chunk = pool[id];
+        Cell &cell = chunk.cells[chunkOffset(pos.first, pos.second)];
+        if (cell == Cell::EMPTY && what != Cell::EMPTY)
+            chunk.used++;
+        else if (cell != Cell::EMPTY && what == Cell::EMPTY && --chunk.used == 0)
+        {
+            table.erase(key);
+            freeChunks.push_back(id);
+            return;
+        }
+        cell = what;
+    }
+
+    void push_front(std::pair<int, int> pos)
+    {
+        snake.push_front(packCell(pos.first, pos.second));
+        set(pos, Cell::SNAKE);
+    }
+
+    void pop_back()
+    {
+        set(unpackCell(snake.pop_back()), Cell::EMPTY);
+    }
+
+    size_t length() const { return snake.size(); }
+    std::pair<int, int> get_front() const { return unpackCell(snake.front()); }
+    std::pair<int, int> get_back() const { return unpackCell(snake.back()); }
+
+    // Segment i counted from the head (0 = head).
+    std::pair<int, int> segment(size_t i) const { return unpackCell(snake[i]); }
+
+    // Starts a fresh game with a one-segment snake at (0, 0).
+    void reset(int food, uint64_t seed)
+    {
+        rng.seed(seed);
+        foodCount = food;
+        score = 0;
+        alive = true;
+        foodShortfall = false;
+        foodMoved = false;
+        foodPositions.clear();
+        snake.clear();
+        pool.clear();
+        freeChunks.clear();
+        table.clear();
+
+        push_front({0, 0});
+        spawnFood();
+    }
+
+    // Tops foodPositions back up to foodCount, each item on a random free
+    // cell of a random chunk near the head. Returns false if some item
+    // found no free cell in FOOD_SPAWN_TRIES attempts.
+    bool spawnFood()
+    {
+        std::pair<int, int> head = get_front();
+        int headChunkRow = head.first >> CHUNK_SHIFT, headChunkCol = head.second >> CHUNK_SHIFT;
+        uint32_t span = 2 * FOOD_SPAWN_CHUNKS + 1;
+
+        int toSpawn = foodCount - static_cast<int>(foodPositions.size());
+        for (int tries = 0; toSpawn > 0 && tries < FOOD_SPAWN_TRIES * toSpawn; ++tries)
+        {
+            int chunkRow = headChunkRow - FOOD_SPAWN_CHUNKS + static_cast<int>(rng.below(span));
+            int chunkCol = headChunkCol - FOOD_SPAWN_CHUNKS + static_cast<int>(rng.below(span));
+            std::pair<int, int> pos = {chunkRow * CHUNK_SIZE + static_cast<int>(rng.below(CHUNK_SIZE)),
+                                       chunkCol * CHUNK_SIZE + static_cast<int>(rng.below(CHUNK_SIZE))};
+            if (cellAt(pos.first, pos.second) != Cell::EMPTY)
+                continue;
+            set(pos, Cell::FOOD);
+            foodPositions.push_back(pos);
+            toSpawn--;
+        }
+
+        foodShortfall = toSpawn > 0;
+        return !foodShortfall;
+    }
+
+    // Moves food more than FOOD_KEEP_CHUNKS chunks from the head back near
+    // it, so food left behind does not pin chunks the snake has abandoned.
+    void recallFood()
+    {
+        std::pair<int, int> head = get_front();
+        int headChunkRow = head.first >> CHUNK_SHIFT, headChunkCol = head.second >> CHUNK_SHIFT;
+        for (size_t i = 0; i < foodPositions.size();)
+        {
+            std::pair<int, int> pos = foodPositions[i];
+            if (std::abs((pos.first >> CHUNK_SHIFT) - headChunkRow) <= FOOD_KEEP_CHUNKS &&
+                std::abs((pos.second >> CHUNK_SHIFT) - headChunkCol) <= FOOD_KEEP_CHUNKS)
+            {
+                ++i;
+                continue;
+            }
+            set(pos, Cell::EMPTY);
+            foodPositions[i] = foodPositions.back();
+            foodPositions.pop_back();
+            foodMoved = true;
+        }
+        if (foodMoved)
+            spawnFood();
+    }
+
+    // Advances the game by one tick with the snake heading in `action`.
+    // Same rules as GameState::step() except that there are no walls.
+    StepResult step(Direction action)
+    {
+        StepResult result;
+        foodMoved = false;
+        if (!alive)
+        {
+            result.outcome = StepOutcome::DIED;
+            return result;
+        }
+
+        int dx = 0, dy = 0;
+        switch (action)
+        {
+        case Direction::UP:
+            dx = -1;
+            break;
+        case Direction::DOWN:
+            dx = 1;
+            break;
+        case Direction::LEFT:
+            dy = -1;
+            break;
+        case Direction::RIGHT:
+            dy = 1;
+            break;
+        }
+
+        std::pair<int, int> currentHead = get_front();
+        std::pair<int, int> newHead = {currentHead.first + dx, currentHead.second + dy};
+        result.newHead = newHead;
+
+        Cell target = cellAt(newHead.first, newHead.second);
+        if (target == Cell::SNAKE)
+        {
+            alive = false;
+            result.outcome = StepOutcome::DIED;
+            return result;
+        }
+
+        bool ate = false;
+        if (target == Cell::FOOD)
+        {
+            score++;
+            ate = true;
+            foodPositions.erase(std::find(foodPositions.begin(), foodPositions.end(), newHead)); // Remove eaten food
+        }
+
+        push_front(newHead);
+
+        if (ate)
+        {
+            result.outcome = StepOutcome::ATE;
+            result.firstNewFood = foodPositions.size();
+            spawnFood();
+        }
+        else
+        {
+            result.outcome = StepOutcome::MOVED;
+            result.vacated = get_back();
+            pop_back();
+        }
+
+        if (chunkKey(newHead.first, newHead.second) != chunkKey(currentHead.first, currentHead.second))
+            recallFood();
+        return result;
+    }
+};
@@ -1,12 +1,14 @@
 #include <iostream>
 #include <vector>
-#include <unordered_set>
+#define NOMINMAX // windows.h's min/max macros break std::min/std::max
 #include <windows.h>
 #include <conio.h>
 #include <chrono>
 #include <ctime>
 #include <algorithm>
 
+#include "../snake_unix/snake_core.h"
+
 #define FOREGROUND_WHITE (FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE)
 #define FOREGROUND_YELLOW (FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN)
 #define FOREGROUND_CYAN (FOREGROUND_INTENSITY | FOREGROUND_GREEN | FOREGROUND_BLUE)
@@ -14,30 +16,15 @@
 
 using namespace std;
 
-const int MAX_SNAKE_LENGTH = 1000;
 int rows = 0, cols = 0;
 int borderWidth = 60;
 int borderHeight = 20;
-unsigned int score = 0;
-enum class Direction
-{
-    UP,
-    DOWN,
-    LEFT,
-    RIGHT
-};
-Direction dir = Direction::RIGHT;
-bool run = true;
-bool playerLost = false;
 
 int screenSwapDelayShort = 50;
 int screenSwapDelayLong = 1000;
 
 int snakeSpeed = 150;
 int foodCount = 1;
-int head = 0, tail = 0, snakeSize = 0;
-pair<int, int> snakeBuffer[MAX_SNAKE_LENGTH];
-vector<pair<int, int>> foodPositions;
 WORD snakeColor = FOREGROUND_GREEN;
 WORD foodColor = FOREGROUND_RED;
 
@@ -46,35 +33,6 @@ chrono::steady_clock::time_point gameStart;
 chrono::steady_clock::time_point pauseStart;
 chrono::steady_clock::duration totalPausedTime = chrono::seconds(0);
 
-struct pair_hash
-{
-    size_t operator()(const pair<int, int> &p) const
-    {
-        return hash<int>()(p.first) ^ (hash<int>()(p.second) << 1);
-    }
-};
-unordered_set<pair<int, int>, pair_hash> snakeBody;
-
-int mod(int x) { return (x + MAX_SNAKE_LENGTH) % MAX_SNAKE_LENGTH; }
-
-void push_front(pair<int, int> pos)
-{
-    head = mod(head - 1);
-    snakeBuffer[head] = pos;
-    snakeSize++;
-    snakeBody.insert(pos);
-}
-
-void pop_back()
-{
-    tail = mod(tail - 1);
-    snakeBody.erase(snakeBuffer[tail]);
-    snakeSize--;
-}
-
-pair<int, int> get_front() { return snakeBuffer[head]; }
-pair<int, int> get_back() { return snakeBuffer[mod(tail - 1)]; }
-
 void moveCursorTo(int row, int col)
 {
     COORD coord = {(SHORT)col, (SHORT)row};
@@ -139,7 +97,7 @@ void DrawBorders(int borderTop, int borderLeft)
     cout.flush();
 }
 
-void drawSidebar(int borderTop, int borderLeft)
+void drawSidebar(int borderTop, unsigned int score)
 {
     moveCursorTo(borderTop, 2);
     setTextColor(FOREGROUND_INTENSITY | FOREGROUND_BLUE);
@@ -161,121 +119,59 @@ void drawSidebar(int borderTop, int borderLeft)
     cout.flush();
 }
 
-void CreateFood(int borderTop, int borderLeft)
+// Policies for the shared game loop in snake_unix/snake_core.h
+
+// Console API output: cursor moves and text attributes
+struct ConsoleTerminal
 {
-    int toSpawn = foodCount - static_cast<int>(foodPositions.size());
-    int attempts = 0, maxAttempts = 500;
+    int top = 0, left = 0;
 
-    while (toSpawn > 0 && attempts++ < maxAttempts)
+    void clear(const GameState &)
     {
-        int fx = borderLeft + 1 + rand() % (borderWidth - 2);
-        int fy = borderTop + 1 + rand() % (borderHeight - 2);
-        pair<int, int> food = {fy, fx};
+        clearScreen();
+        getTerminalSize(rows, cols);
+        top = (rows - borderHeight) / 2;
+        left = (cols - borderWidth) / 2;
+        DrawBorders(top, left);
+    }
 
-        if (snakeBody.count(food) == 0 &&
-            find(foodPositions.begin(), foodPositions.end(), food) == foodPositions.end())
+    // Board cells sit inside the border: row 0 is at `top`, column 0 just right of `left`.
+    void cell(pair<int, int> pos, Cell what)
+    {
+        moveCursorTo(top + pos.first, left + 1 + pos.second);
+        if (what == Cell::EMPTY)
         {
-            foodPositions.push_back(food);
-            moveCursorTo(fy, fx);
-            setTextColor(foodColor);
-            cout << "@";
-            setTextColor(FOREGROUND_WHITE);
-            toSpawn--;
+            cout << " ";
+            return;
         }
+        setTextColor(what == Cell::SNAKE ? snakeColor : foodColor);
+        cout << (what == Cell::SNAKE ? "S" : "@");
+        setTextColor(FOREGROUND_WHITE);
     }
-}
 
-void DrawSnake()
-{
-    for (int i = 0; i < snakeSize; ++i)
-    {
-        auto pos = snakeBuffer[mod(head + i)];
-        moveCursorTo(pos.first, pos.second);
-        setTextColor(snakeColor);
-        cout << "S";
-    }
-    setTextColor(FOREGROUND_WHITE);
-}
+    void present(const GameState &game) { drawSidebar(top, game.score); }
+};
 
-Direction charToDirection(char ch)
+struct SleepClock
 {
-    switch (ch)
-    {
-    case 'w':
-        return Direction::UP;
-    case 's':
-        return Direction::DOWN;
-    case 'a':
-        return Direction::LEFT;
-    case 'd':
-        return Direction::RIGHT;
-    default:
-        return dir;
-    }
-}
+    void start() {}
+    void wait() { Sleep(snakeSpeed); }
+};
 
-void UpdateSnake(int borderTop, int borderLeft)
+struct ConsoleInput
 {
-    int dx = 0, dy = 0;
-    switch (dir)
-    {
-    case Direction::UP:
-        dx = -1;
-        break;
-    case Direction::DOWN:
-        dx = 1;
-        break;
-    case Direction::LEFT:
-        dy = -1;
-        break;
-    case Direction::RIGHT:
-        dy = 1;
-        break;
-    }
-
-    pair<int, int> currentHead = get_front();
-    int newRow = currentHead.first + dx;
-    int newCol = currentHead.second + dy;
-    pair<int, int> newHead = {newRow, newCol};
-
-    if (newRow < borderTop ||
-        newRow >= borderTop + borderHeight ||
-        newCol <= borderLeft ||
-        newCol >= borderLeft + borderWidth ||
-        snakeBody.count(newHead))
-    {
-        playerLost = true;
-        run = false;
-        return;
-    }
-
-    bool ate = false;
-    for (size_t i = 0; i < foodPositions.size(); ++i)
+    template <typename F>
+    void poll(F &&onKey)
     {
-        if (newRow == foodPositions[i].first && newCol == foodPositions[i].second)
+        while (_kbhit())
         {
-            score++;
-            ate = true;
-            foodPositions.erase(foodPositions.begin() + i);
-            break;
+            if (!onKey(static_cast<char>(_getch())))
+                return;
         }
     }
+};
 
-    push_front(newHead);
-
-    if (!ate)
-    {
-        moveCursorTo(get_back().first, get_back().second);
-        cout << " ";
-        pop_back();
-    }
-    else
-    {
-        CreateFood(borderTop, borderLeft);
-    }
-
-    DrawSnake();
-}
+GameCore<ConsoleTerminal, SleepClock, ConsoleInput> core;
 
 bool gameOverScreen()
 {
@@ -304,7 +200,7 @@ bool gameOverScreen()
 
     moveCursorTo(centerRow, centerCol);
     setTextColor(FOREGROUND_WHITE);
-    cout << "Your final score: " << score;
+    cout << "Your final score: " << core.game.score;
 
     moveCursorTo(centerRow + 2, centerCol);
     setTextColor(FOREGROUND_WHITE);
@@ -330,12 +226,6 @@ bool gameOverScreen()
                 Sleep(1000);
             }
 
-            run = true;
-            score = 0;
-            dir = Direction::RIGHT;
-            foodPositions.clear();
-            head = tail = snakeSize = 0;
-            snakeBody.clear();
             clearScreen();
             return true;
         }
@@ -506,6 +396,7 @@ void settingsMenu()
                 Sleep(10);
             } while (c != '1' && c != '2' && c != '3');
             foodCount = c - '0';
+            core.game.foodCount = foodCount;
 
             moveCursorTo(rows / 2 + 1, cols / 2 - 10);
             setTextColor(FOREGROUND_WHITE);
@@ -547,16 +438,7 @@ void pauseMenu()
         if (ch == '1' || ch == 27)
         {
             totalPausedTime += chrono::steady_clock::now() - pauseStart;
-            clearScreen();
-            DrawBorders((rows - borderHeight) / 2, (cols - borderWidth) / 2);
-            DrawSnake();
-            for (const auto &food : foodPositions)
-            {
-                moveCursorTo(food.first, food.second);
-                setTextColor(foodColor);
-                cout << "@";
-                setTextColor(FOREGROUND_WHITE);
-            }
+            core.redraw();
             cout.flush();
             break;
         }
@@ -567,85 +449,27 @@ void pauseMenu()
         }
         else if (ch == '3')
         {
-            run = false;
-            playerLost = false;
+            core.running = false;
             break;
         }
         Sleep(screenSwapDelayShort);
     }
 }
 
-void handleInput()
-{
-    if (_kbhit())
-    {
-        char ch = _getch();
-        if (ch == 27)
-        {
-            pauseMenu();
-            return;
-        }
-        if (ch == 'q')
-        {
-            run = false;
-        }
-        Direction newDir = charToDirection(ch);
-        switch (newDir)
-        {
-        case Direction::UP:
-            if (dir != Direction::DOWN)
-                dir = Direction::UP;
-            break;
-        case Direction::DOWN:
-            if (dir != Direction::UP)
-                dir = Direction::DOWN;
-            break;
-        case Direction::LEFT:
-            if (dir != Direction::RIGHT)
-                dir = Direction::LEFT;
-            break;
-        case Direction::RIGHT:
-            if (dir != Direction::LEFT)
-                dir = Direction::RIGHT;
-            break;
-        }
-    }
-}
-
-void initializeGame(int &borderTop, int &borderLeft)
+void initializeGame()
 {
     hideCursor();
-    clearScreen();
-
-    getTerminalSize(rows, cols);
-    borderTop = (rows - borderHeight) / 2;
-    borderLeft = (cols - borderWidth) / 2;
-    DrawBorders(borderTop, borderLeft);
-
-    int midRow = borderTop + borderHeight / 2;
-    int midCol = borderLeft + borderWidth / 2;
-    pair<int, int> start = {midRow, midCol};
-    push_front(start);
-
-    moveCursorTo(midRow, midCol);
-    setTextColor(snakeColor);
-    cout << "S";
-    setTextColor(FOREGROUND_WHITE);
-
-    srand((unsigned int)time(0));
-    CreateFood(borderTop, borderLeft);
-
+    core.reset(borderWidth - 1, borderHeight, foodCount, static_cast<uint64_t>(time(0)));
     gameStart = chrono::steady_clock::now();
 }
 
-void gameLoop(int borderTop, int borderLeft)
+void gameLoop()
 {
-    while (run)
+    while (core.running)
     {
-        handleInput();
-        UpdateSnake(borderTop, borderLeft);
-        drawSidebar(borderTop, borderLeft);
-        Sleep(snakeSpeed);
+        if (core.tick() == 27) // ESC key
+            pauseMenu();
+        core.clock.wait();
     }
 }
 
@@ -656,11 +480,10 @@ int main()
 
     while (true)
     {
-        int borderTop, borderLeft;
-        initializeGame(borderTop, borderLeft);
-        gameLoop(borderTop, borderLeft);
+        initializeGame();
+        gameLoop();
 
-        if (playerLost)
+        if (!core.game.alive)
         {
             if (!gameOverScreen())
                 break;